@@ -0,0 +1,301 @@
+// cpu-server-bench — замеры горячих путей конвейера прием → история → график.
+// Запуск с выводом в JSON для отслеживания регрессий:
+//   ./cpu-server-bench --benchmark_out=bench.json --benchmark_out_format=json
+
+#include <benchmark/benchmark.h>
+
+#include "anomalydetector.h"
+#include "cpuaggregates.h"
+#include "cpuhistory.h"
+#include "cpuprotocol.h"
+#include "qcustomplot.h"
+#include "topologymap.h"
+
+#include <QApplication>
+#include <QRandomGenerator>
+
+namespace {
+
+constexpr int HISTORY_POINTS = 300;
+
+QByteArray makeDatagram(int coreCount, quint32 sequence, bool channels = false)
+{
+    QRandomGenerator rng(sequence);
+    QByteArray data = "Host: bench\nSeq: " + QByteArray::number(sequence) + "\nTotal: 42.0%\n";
+    for (int i = 0; i < coreCount; ++i) {
+        data += "Core " + QByteArray::number(i) + ": "
+                + QByteArray::number(rng.generateDouble() * 100.0, 'f', 1) + "%";
+        if (channels) {
+            data += " user=30.2 sys=8.1 iowait=1.0 steal=0.0 irq=2.2 freq=2400";
+        }
+        data += "\n";
+    }
+    return data;
+}
+
+QVector<double> makeUsages(int coreCount, quint32 seed)
+{
+    QRandomGenerator rng(seed);
+    QVector<double> usages(coreCount);
+    for (double &usage : usages) {
+        usage = rng.generateDouble() * 100.0;
+    }
+    return usages;
+}
+
+// История, заполненная до емкости, — установившийся режим работы сервера
+void fillHistory(CpuHistory &history, int coreCount, int points)
+{
+    const QVector<double> usages = makeUsages(coreCount, 1);
+    history.updateCoreSet(usages);
+    for (int i = 0; i < points; ++i) {
+        history.append(i, usages, 50.0);
+    }
+}
+
+// Настройка графика как в MainWindow::setupUI
+void setupPlot(QCustomPlot &plot, int coreCount, int points)
+{
+    // Скрытый виджет не получает resizeEvent, поэтому область графика задается явно:
+    // иначе перерисовка идет в размере по умолчанию, а не 900x600
+    plot.resize(900, 600);
+    plot.setViewport(QRect(0, 0, 900, 600));
+    plot.yAxis2->setVisible(true);
+    plot.xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    plot.yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    QSharedPointer<QCPAxisTickerDateTime> dateTimeTicker(new QCPAxisTickerDateTime);
+    dateTimeTicker->setDateTimeFormat("HH.mm");
+    plot.xAxis->setTicker(dateTimeTicker);
+    plot.xAxis->setRange(0, points);
+    plot.yAxis->setRange(0, 100);
+
+    QVector<double> keys(points);
+    for (int i = 0; i < points; ++i) {
+        keys[i] = i;
+    }
+
+    for (int c = 0; c < coreCount; ++c) {
+        QCPGraph *graph = plot.addGraph();
+        graph->setPen(QPen(QColor::fromHsv((c * 41) % 360, 200, 255), 1));
+        graph->setData(keys, makeUsages(points, c), true);
+    }
+    QCPGraph *total = plot.addGraph();
+    total->setPen(QPen(Qt::black, 4));
+    total->setData(keys, makeUsages(points, coreCount), true);
+}
+
+} // namespace
+
+// Разбор текстовой датаграммы (логика parseAndDisplay)
+static void BM_ParseDatagram(benchmark::State &state)
+{
+    const QByteArray datagram = makeDatagram(static_cast<int>(state.range(0)), 1);
+    CpuSample sample;
+    for (auto _ : state) {
+        bool ok = CpuProtocol::parseDatagram(datagram, "127.0.0.1:5000", sample);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * datagram.size());
+}
+BENCHMARK(BM_ParseDatagram)->Arg(8)->Arg(64)->Arg(256);
+
+// То же с расширенными каналами user/sys/iowait/steal/irq/freq на каждом ядре
+static void BM_ParseDatagramChannels(benchmark::State &state)
+{
+    const QByteArray datagram = makeDatagram(static_cast<int>(state.range(0)), 1, true);
+    CpuSample sample;
+    for (auto _ : state) {
+        bool ok = CpuProtocol::parseDatagram(datagram, "127.0.0.1:5000", sample);
+        benchmark::DoNotOptimize(ok);
+    }
+    state.SetItemsProcessed(state.iterations());
+    state.SetBytesProcessed(state.iterations() * datagram.size());
+}
+BENCHMARK(BM_ParseDatagramChannels)->Arg(8)->Arg(64)->Arg(256);
+
+// Добавление точки в заполненную историю с вытеснением самой старой
+static void BM_HistoryAppend(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    CpuHistory history(HISTORY_POINTS);
+    fillHistory(history, coreCount, HISTORY_POINTS);
+    const QVector<double> usages = makeUsages(coreCount, 2);
+
+    double time = HISTORY_POINTS;
+    for (auto _ : state) {
+        history.append(time, usages, 50.0);
+        time += 1.0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_HistoryAppend)->Arg(8)->Arg(64)->Arg(256);
+
+// Детектор аномалий на сэмпл; сравнивается с BM_HistoryAppend при том же числе ядер
+static void BM_AnomalyDetect(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    const QVector<double> first = makeUsages(coreCount, 3);
+    const QVector<double> second = makeUsages(coreCount, 4);
+    AnomalyDetector detector;
+
+    double time = 0.0;
+    for (auto _ : state) {
+        detector.add(time, 50.0, static_cast<qint64>(time) % 2 ? first : second);
+        time += 1.0;
+    }
+    benchmark::DoNotOptimize(detector.anomalyCount());
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_AnomalyDetect)->Arg(8)->Arg(64)->Arg(256);
+
+// Среднее и неравномерность по ядрам сэмпла (логика CpuIngest::processSample)
+static void BM_CoreStats(benchmark::State &state)
+{
+    const QVector<double> usages = makeUsages(static_cast<int>(state.range(0)), 5);
+    for (auto _ : state) {
+        const CoreStats stats = CpuAggregates::coreStats(usages);
+        benchmark::DoNotOptimize(stats.imbalance.gini);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_CoreStats)->Arg(8)->Arg(64)->Arg(256);
+
+// Агрегаты по NUMA-узлам при приеме: 2 сокета, SMT 2, индекс «ядро → узел»
+static void BM_TopologyAggregate(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    const int physicalCount = coreCount / 2;
+    QVector<CoreTopology> cores(coreCount);
+    for (int c = 0; c < coreCount; ++c) {
+        const int physical = c % physicalCount;
+        cores[c].socket = cores[c].node = physical * 2 / physicalCount;
+        cores[c].physicalCore = physical;
+    }
+    TopologyMap topology;
+    topology.update(cores);
+
+    const QVector<double> usages = makeUsages(coreCount, 6);
+    QVector<double> nodeUsages;
+    QVector<int> counts;
+    for (auto _ : state) {
+        topology.aggregate(TopologyMap::Level::Node, usages, nodeUsages, counts);
+        benchmark::DoNotOptimize(nodeUsages.data());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_TopologyAggregate)->Arg(8)->Arg(64)->Arg(256);
+
+// Поиск максимума в видимом окне (логика updateYAxisRange)
+static void BM_YAxisRange(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    CpuHistory history(HISTORY_POINTS);
+    fillHistory(history, coreCount, HISTORY_POINTS);
+
+    for (auto _ : state) {
+        double yMax = history.maxValueSince(0.0);
+        benchmark::DoNotOptimize(yMax);
+    }
+}
+BENCHMARK(BM_YAxisRange)->Arg(8)->Arg(64)->Arg(256);
+
+// Полная замена данных графика, как в MainWindow::refreshGraphData
+static void BM_GraphSetData(benchmark::State &state)
+{
+    const int points = static_cast<int>(state.range(0));
+    QCustomPlot plot;
+    QCPGraph *graph = plot.addGraph();
+    QVector<double> keys(points);
+    for (int i = 0; i < points; ++i) {
+        keys[i] = i;
+    }
+    const QVector<double> values = makeUsages(points, 3);
+
+    for (auto _ : state) {
+        graph->setData(keys, values, true);
+    }
+    state.SetItemsProcessed(state.iterations() * points);
+}
+BENCHMARK(BM_GraphSetData)->Arg(300)->Arg(3000)->Arg(30000);
+
+// Альтернатива: добавление одной точки и удаление вышедших за окно
+static void BM_GraphAddData(benchmark::State &state)
+{
+    const int points = static_cast<int>(state.range(0));
+    QCustomPlot plot;
+    QCPGraph *graph = plot.addGraph();
+    QVector<double> keys(points);
+    for (int i = 0; i < points; ++i) {
+        keys[i] = i;
+    }
+    graph->setData(keys, makeUsages(points, 4), true);
+
+    double key = points;
+    for (auto _ : state) {
+        graph->addData(key, 50.0);
+        graph->data()->removeBefore(key - points + 1);
+        key += 1.0;
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GraphAddData)->Arg(300)->Arg(3000)->Arg(30000);
+
+// Перерисовка графика вне экрана: число ядер × длина истории
+static void BM_Replot(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    const int points = static_cast<int>(state.range(1));
+    QCustomPlot plot;
+    setupPlot(plot, coreCount, points);
+    plot.replot();
+
+    for (auto _ : state) {
+        plot.replot();
+    }
+    state.counters["replotTimeMs"] = plot.replotTime(true);
+}
+BENCHMARK(BM_Replot)
+    ->ArgsProduct({{8, 64, 256}, {300, 3000}})
+    ->Unit(benchmark::kMillisecond);
+
+// Перерисовка только буферизованного слоя с данными (диапазоны осей не менялись);
+// сравнивается с BM_Replot при тех же аргументах
+static void BM_ReplotDataLayer(benchmark::State &state)
+{
+    const int coreCount = static_cast<int>(state.range(0));
+    const int points = static_cast<int>(state.range(1));
+    QCustomPlot plot;
+    setupPlot(plot, coreCount, points);
+    plot.addLayer("data", plot.layer("main"), QCustomPlot::limAbove);
+    QCPLayer *dataLayer = plot.layer("data");
+    dataLayer->setMode(QCPLayer::lmBuffered);
+    for (int i = 0; i < plot.graphCount(); ++i) {
+        plot.graph(i)->setLayer(dataLayer);
+    }
+    plot.replot();
+
+    for (auto _ : state) {
+        dataLayer->replot();
+    }
+}
+BENCHMARK(BM_ReplotDataLayer)
+    ->ArgsProduct({{8, 64, 256}, {300, 3000}})
+    ->Unit(benchmark::kMillisecond);
+
+int main(int argc, char *argv[])
+{
+    // QCustomPlot — виджет, поэтому нужен QApplication; окно не показывается
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
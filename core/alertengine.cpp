@@ -0,0 +1,354 @@
+#include "alertengine.h"
+#include "cpumonitorlog.h"
+#include "tracing.h"
+#include <QRegularExpression>
+
+namespace {
+
+// Порог снятия по умолчанию: на столько ниже порога срабатывания
+constexpr double DEFAULT_HYSTERESIS = 5.0;
+constexpr double DEFAULT_GINI_HYSTERESIS = 0.05;
+
+bool fail(QString *errorString, const QString &message)
+{
+    if (errorString) {
+        *errorString = message;
+    }
+    return false;
+}
+
+// «30», «30s», «5m», «1h» — в секундах; -1 — ошибка
+double parseDuration(const QString &text)
+{
+    static const QRegularExpression re("^(\\d+(?:\\.\\d+)?)([smh]?)$");
+    const QRegularExpressionMatch match = re.match(text);
+    if (!match.hasMatch()) {
+        return -1.0;
+    }
+    const double value = match.captured(1).toDouble();
+    const QString unit = match.captured(2);
+    return unit == "h" ? value * 3600.0 : unit == "m" ? value * 60.0 : value;
+}
+
+} // namespace
+
+bool AlertRule::parse(const QString &text, AlertRule &rule, QString *errorString)
+{
+    rule = AlertRule();
+    rule.text = text.simplified();
+    QStringList tokens = rule.text.toLower().split(' ');
+
+    // Хвост «clear N» разбирается отдельно
+    double clearThreshold = std::nan("");
+    if (tokens.size() >= 2 && tokens[tokens.size() - 2] == "clear") {
+        bool ok = false;
+        clearThreshold = QString(tokens.last()).remove('%').toDouble(&ok);
+        if (!ok) {
+            return fail(errorString, QString("Invalid clear threshold in rule: %1").arg(text));
+        }
+        tokens.resize(tokens.size() - 2);
+    }
+
+    if (tokens.size() == 2 && tokens[0] == "missing") {
+        rule.kind = Kind::Missing;
+        rule.durationSec = parseDuration(tokens[1]);
+        if (rule.durationSec <= 0.0) {
+            return fail(errorString, QString("Invalid duration in rule: %1").arg(text));
+        }
+        return true;
+    }
+
+    if (tokens.size() != 5 || tokens[1] != ">") {
+        return fail(errorString, QString("Expected '<total|core|spread|stddev|gini> > N <for|avg> DURATION' "
+                                         "or 'missing DURATION': %1").arg(text));
+    }
+    if (tokens[0] == "total") {
+        rule.series = Series::Total;
+    } else if (tokens[0] == "core") {
+        rule.series = Series::AnyCore;
+    } else if (tokens[0] == "spread") {
+        rule.series = Series::Spread;
+    } else if (tokens[0] == "stddev") {
+        rule.series = Series::StdDev;
+    } else if (tokens[0] == "gini") {
+        rule.series = Series::Gini;
+    } else {
+        return fail(errorString, QString("Unknown series '%1' in rule: %2").arg(tokens[0], text));
+    }
+
+    bool ok = false;
+    rule.threshold = QString(tokens[2]).remove('%').toDouble(&ok);
+    if (!ok) {
+        return fail(errorString, QString("Invalid threshold in rule: %1").arg(text));
+    }
+
+    if (tokens[3] == "for") {
+        rule.kind = Kind::Sustained;
+    } else if (tokens[3] == "avg") {
+        rule.kind = Kind::Average;
+    } else {
+        return fail(errorString, QString("Expected 'for' or 'avg' in rule: %1").arg(text));
+    }
+    rule.durationSec = parseDuration(tokens[4]);
+    // «for 0s» срабатывает на первом сэмпле выше порога; окно среднего не может быть пустым
+    if (rule.durationSec < 0.0 || (rule.kind == Kind::Average && rule.durationSec == 0.0)) {
+        return fail(errorString, QString("Invalid duration in rule: %1").arg(text));
+    }
+
+    const double hysteresis = rule.series == Series::Gini ? DEFAULT_GINI_HYSTERESIS : DEFAULT_HYSTERESIS;
+    rule.clearThreshold = std::isnan(clearThreshold) ? rule.threshold - hysteresis : clearThreshold;
+    if (rule.clearThreshold > rule.threshold) {
+        return fail(errorString, QString("Clear threshold above trigger threshold in rule: %1").arg(text));
+    }
+    return true;
+}
+
+QString AlertEvent::valueText() const
+{
+    if (kind == AlertRule::Kind::Missing) {
+        return QString("silent %1 s").arg(value, 0, 'f', 0);
+    }
+    if (std::isnan(value)) {
+        return "offline";
+    }
+    if (series == AlertRule::Series::Gini) {
+        return QString::number(value, 'f', 2);
+    }
+    return QString("%1%").arg(value, 0, 'f', 1);
+}
+
+QString AlertEvent::toString() const
+{
+    QString target = hostId;
+    if (core >= 0) {
+        target += QString(" core %1").arg(core);
+    }
+    return QString("%1 %2: %3 (%4)")
+        .arg(state == State::Firing ? "FIRING" : "RESOLVED", target, rule, valueText());
+}
+
+void AlertEngine::WindowAverage::add(double timeSec, double value, double bucketSec)
+{
+    const qint64 bucket = static_cast<qint64>(std::floor(timeSec / bucketSec));
+    if (headBucket < 0) {
+        firstBucket = headBucket = bucket;
+    } else if (bucket <= headBucket - WINDOW_BUCKETS) {
+        // Опоздавший сэмпл старше окна
+        return;
+    } else if (bucket > headBucket) {
+        // Освобождаем корзины, вышедшие из окна; не больше WINDOW_BUCKETS за раз
+        const qint64 last = qMin(bucket, headBucket + WINDOW_BUCKETS);
+        for (qint64 b = headBucket + 1; b <= last; ++b) {
+            const int slot = static_cast<int>(b % WINDOW_BUCKETS);
+            sum -= sums[slot];
+            count -= counts[slot];
+            sums[slot] = 0.0;
+            counts[slot] = 0;
+        }
+        if (count == 0) {
+            // Сбрасываем накопленную ошибку округления
+            sum = 0.0;
+        }
+        headBucket = bucket;
+    }
+
+    const int slot = static_cast<int>(bucket % WINDOW_BUCKETS);
+    sums[slot] += value;
+    ++counts[slot];
+    sum += value;
+    ++count;
+}
+
+AlertEngine::AlertEngine(QObject *parent)
+    : QObject(parent)
+{
+    qRegisterMetaType<AlertEvent>();
+}
+
+AlertEngine::~AlertEngine()
+{
+    qDeleteAll(hostList);
+}
+
+QVector<AlertRule> AlertEngine::defaultRules()
+{
+    QVector<AlertRule> rules;
+    for (const char *text : {"core > 95 for 30s", "total > 80 avg 5m", "spread > 60 for 30s", "missing 10s"}) {
+        AlertRule rule;
+        AlertRule::parse(text, rule);
+        rules.append(rule);
+    }
+    return rules;
+}
+
+void AlertEngine::setRules(const QVector<AlertRule> &rules)
+{
+    ruleList = rules;
+    qDeleteAll(hostList);
+    hostList.clear();
+    hostsById.clear();
+    active = 0;
+}
+
+AlertEngine::HostState *AlertEngine::hostFor(const QString &id)
+{
+    HostState *host = hostsById.value(id);
+    if (!host) {
+        host = new HostState;
+        host->id = id;
+        host->rules.resize(ruleList.size());
+        for (RuleState &state : host->rules) {
+            state.series.resize(1);
+        }
+        hostsById.insert(id, host);
+        hostList.append(host);
+    }
+    return host;
+}
+
+void AlertEngine::addSample(const QString &hostId, double timeSec, const QVector<double> &coreUsages,
+                            double total, const CoreImbalance &imbalance)
+{
+    TRACE_SCOPE("AlertEngine::addSample");
+
+    HostState *host = hostFor(hostId);
+    const double silenceSec = timeSec - host->lastSeenSec;
+    host->lastSeenSec = timeSec;
+
+    for (int r = 0; r < ruleList.size(); ++r) {
+        const AlertRule &rule = ruleList[r];
+        RuleState &state = host->rules[r];
+
+        if (rule.kind == AlertRule::Kind::Missing) {
+            if (state.series[0].active) {
+                setActive(state.series[0], false, r, *host, -1, silenceSec, timeSec);
+            }
+            continue;
+        }
+
+        switch (rule.series) {
+        case AlertRule::Series::Total:
+            evaluate(r, state, 0, total, *host, -1, timeSec);
+            continue;
+        case AlertRule::Series::Spread:
+            // Событие указывает на ядро-«горячую точку»
+            evaluate(r, state, 0, imbalance.spread, *host, imbalance.hottestCore, timeSec);
+            continue;
+        case AlertRule::Series::StdDev:
+            evaluate(r, state, 0, imbalance.stddev, *host, -1, timeSec);
+            continue;
+        case AlertRule::Series::Gini:
+            evaluate(r, state, 0, imbalance.gini, *host, -1, timeSec);
+            continue;
+        case AlertRule::Series::AnyCore:
+            break;
+        }
+
+        // Состояние по ядрам следует за числом ядер хоста; оповещения ушедших ядер снимаются
+        const int coreCount = coreUsages.size();
+        if (state.series.size() > coreCount) {
+            for (int core = coreCount; core < state.series.size(); ++core) {
+                if (state.series[core].active) {
+                    setActive(state.series[core], false, r, *host, core, std::nan(""), timeSec);
+                }
+            }
+            state.series.resize(qMax(coreCount, 1));
+            if (state.windows.size() > state.series.size()) {
+                state.windows.resize(state.series.size());
+            }
+        } else if (state.series.size() < coreCount) {
+            state.series.resize(coreCount);
+        }
+        for (int core = 0; core < coreCount; ++core) {
+            evaluate(r, state, core, coreUsages[core], *host, core, timeSec);
+        }
+    }
+}
+
+void AlertEngine::evaluate(int ruleIndex, RuleState &state, int seriesIndex, double value,
+                           const HostState &host, int core, double timeSec)
+{
+    // Ряд пропал (ядро offline): горящее оповещение снимается, отсчет длительности
+    // начинается заново; окно среднего сохраняется — NaN в него не попадает
+    if (std::isnan(value)) {
+        SeriesState &series = state.series[seriesIndex];
+        if (series.active) {
+            setActive(series, false, ruleIndex, host, core, value, timeSec);
+        }
+        series.pendingSince = std::nan("");
+        return;
+    }
+
+    const AlertRule &rule = ruleList[ruleIndex];
+    if (rule.kind == AlertRule::Kind::Average) {
+        if (state.windows.size() <= seriesIndex) {
+            state.windows.resize(state.series.size());
+        }
+        WindowAverage &window = state.windows[seriesIndex];
+        window.add(timeSec, value, rule.durationSec / WINDOW_BUCKETS);
+        if (!window.isFull()) {
+            return;
+        }
+        value = window.mean();
+    }
+
+    SeriesState &series = state.series[seriesIndex];
+    if (series.active) {
+        // Гистерезис: снимаем, только когда значение ушло ниже порога снятия
+        if (value < rule.clearThreshold) {
+            setActive(series, false, ruleIndex, host, core, value, timeSec);
+        }
+        return;
+    }
+
+    if (!(value > rule.threshold)) {
+        series.pendingSince = std::nan("");
+        return;
+    }
+    if (rule.kind == AlertRule::Kind::Sustained) {
+        if (std::isnan(series.pendingSince)) {
+            series.pendingSince = timeSec;
+        }
+        if (timeSec - series.pendingSince < rule.durationSec) {
+            return;
+        }
+    }
+    setActive(series, true, ruleIndex, host, core, value, timeSec);
+}
+
+void AlertEngine::checkMissing(double nowSec)
+{
+    for (int r = 0; r < ruleList.size(); ++r) {
+        const AlertRule &rule = ruleList[r];
+        if (rule.kind != AlertRule::Kind::Missing) {
+            continue;
+        }
+        for (HostState *host : hostList) {
+            SeriesState &series = host->rules[r].series[0];
+            const double silenceSec = nowSec - host->lastSeenSec;
+            if (!series.active && silenceSec >= rule.durationSec) {
+                setActive(series, true, r, *host, -1, silenceSec, nowSec);
+            }
+        }
+    }
+}
+
+void AlertEngine::setActive(SeriesState &series, bool firing, int ruleIndex, const HostState &host,
+                            int core, double value, double timeSec)
+{
+    series.active = firing;
+    series.pendingSince = std::nan("");
+    active += firing ? 1 : -1;
+
+    AlertEvent event;
+    event.state = firing ? AlertEvent::State::Firing : AlertEvent::State::Resolved;
+    event.rule = ruleList[ruleIndex].text;
+    event.kind = ruleList[ruleIndex].kind;
+    event.series = ruleList[ruleIndex].series;
+    event.hostId = host.id;
+    event.core = core;
+    event.value = value;
+    event.timeSec = timeSec;
+    qCInfo(cpuMonitor).noquote() << "Alert" << event.toString();
+    emit alertChanged(event);
+}
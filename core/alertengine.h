@@ -0,0 +1,147 @@
+#ifndef ALERTENGINE_H
+#define ALERTENGINE_H
+
+#include "cpuaggregates.h"
+#include <QHash>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <cmath>
+
+// Правило оповещения. Текстовая форма (регистр не важен):
+//   total > 80 avg 5m       — средняя общая загрузка за окно выше порога
+//   core > 95 for 30s       — загрузка любого ядра выше порога дольше заданного
+//   missing 10s             — хост молчит дольше заданного
+//   spread > 60 for 30s     — самое загруженное ядро выше среднего по ядрам
+// Ряды неравномерности: spread и stddev (в процентах), gini (0..1).
+// Необязательный хвост «clear N» задает порог снятия; по умолчанию — порог
+// минус 5 (для gini — минус 0.05).
+struct AlertRule
+{
+    enum class Kind {
+        Sustained,  // значение выше порога непрерывно durationSec
+        Average,    // среднее за окно durationSec выше порога
+        Missing     // нет сэмплов durationSec
+    };
+    enum class Series {
+        Total,      // общая загрузка хоста
+        AnyCore,    // каждое ядро отдельно
+        Spread,     // максимум минус среднее по ядрам
+        StdDev,     // стандартное отклонение по ядрам
+        Gini        // коэффициент Джини по ядрам
+    };
+
+    QString text;
+    Kind kind = Kind::Sustained;
+    Series series = Series::Total;
+    double threshold = 0.0;
+    double clearThreshold = 0.0;  // гистерезис: оповещение снимается ниже этого значения
+    double durationSec = 0.0;
+
+    static bool parse(const QString &text, AlertRule &rule, QString *errorString = nullptr);
+};
+
+// Смена состояния оповещения по одному ряду одного хоста
+struct AlertEvent
+{
+    enum class State { Firing, Resolved };
+
+    State state = State::Firing;
+    QString rule;               // текст правила
+    AlertRule::Kind kind = AlertRule::Kind::Sustained;
+    AlertRule::Series series = AlertRule::Series::Total;
+    QString hostId;
+    int core = -1;              // -1 — хост целиком; для spread — самое загруженное ядро
+    double value = std::nan(""); // значение, вызвавшее смену; для missing — секунды молчания,
+                                 // NaN — ряд пропал (ядро offline или ушло из набора)
+    double timeSec = 0.0;
+
+    // Значение для показа: «96.2%», «0.71», «offline» или «silent 12 s»
+    QString valueText() const;
+    QString toString() const;
+};
+Q_DECLARE_METATYPE(AlertEvent)
+
+// Инкрементальная проверка правил на каждом сэмпле. Состояние постоянного
+// размера на правило и ряд (для среднего — кольцо из WINDOW_BUCKETS корзин),
+// поэтому стоимость сэмпла не зависит от длины истории. События идут через
+// сигнал alertChanged: к нему подключаются интерфейс, журнал и экспортеры.
+class AlertEngine : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit AlertEngine(QObject *parent = nullptr);
+    ~AlertEngine() override;
+
+    // Правила по умолчанию — примеры из текстовой формы выше
+    static QVector<AlertRule> defaultRules();
+    // Заменяет правила; состояние всех хостов сбрасывается
+    void setRules(const QVector<AlertRule> &rules);
+    const QVector<AlertRule> &rules() const { return ruleList; }
+
+    void addSample(const QString &hostId, double timeSec, const QVector<double> &coreUsages, double total,
+                   const CoreImbalance &imbalance);
+    // Правила missing проверяются по таймеру: от молчащего хоста сэмплов нет
+    void checkMissing(double nowSec);
+
+    int activeCount() const { return active; }
+
+signals:
+    void alertChanged(const AlertEvent &event);
+
+private:
+    static constexpr int WINDOW_BUCKETS = 10;
+
+    // Скользящее среднее за окно из WINDOW_BUCKETS корзин по времени: сэмпл
+    // добавляется в свою корзину, устаревшие корзины вычитаются из суммы
+    class WindowAverage
+    {
+    public:
+        void add(double timeSec, double value, double bucketSec);
+        // Окно заполнено целиком — среднее можно сравнивать с порогом
+        bool isFull() const { return headBucket >= 0 && headBucket - firstBucket >= WINDOW_BUCKETS - 1; }
+        double mean() const { return count ? sum / count : std::nan(""); }
+
+    private:
+        double sums[WINDOW_BUCKETS] = {};
+        quint32 counts[WINDOW_BUCKETS] = {};
+        qint64 firstBucket = -1;
+        qint64 headBucket = -1;
+        double sum = 0.0;
+        quint32 count = 0;
+    };
+
+    struct SeriesState
+    {
+        double pendingSince = std::nan("");  // с какого момента значение выше порога
+        bool active = false;
+    };
+
+    struct RuleState
+    {
+        QVector<SeriesState> series;     // AnyCore — по ядрам, остальные — один ряд
+        QVector<WindowAverage> windows;  // только для Average
+    };
+
+    struct HostState
+    {
+        QString id;
+        double lastSeenSec = 0.0;
+        QVector<RuleState> rules;
+    };
+
+    HostState *hostFor(const QString &id);
+    void evaluate(int ruleIndex, RuleState &state, int seriesIndex, double value,
+                  const HostState &host, int core, double timeSec);
+    void setActive(SeriesState &series, bool firing, int ruleIndex, const HostState &host,
+                   int core, double value, double timeSec);
+
+    QVector<AlertRule> ruleList;
+    QHash<QString, HostState*> hostsById;
+    QVector<HostState*> hostList;
+    int active = 0;
+};
+
+#endif // ALERTENGINE_H
@@ -0,0 +1,33 @@
+#include "alertlog.h"
+#include <QDateTime>
+
+bool AlertLog::open(const QString &path, QString *errorString)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    return true;
+}
+
+void AlertLog::close()
+{
+    file.close();
+}
+
+bool AlertLog::write(const AlertEvent &event)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    const QDateTime time = QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(event.timeSec * 1000.0));
+    const QByteArray line = (time.toString(Qt::ISODateWithMs) + ' ' + event.toString() + '\n').toUtf8();
+    if (file.write(line) != line.size()) {
+        return false;
+    }
+    return file.flush();
+}
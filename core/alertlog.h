@@ -0,0 +1,24 @@
+#ifndef ALERTLOG_H
+#define ALERTLOG_H
+
+#include "alertengine.h"
+#include <QFile>
+#include <QString>
+
+// Журнал оповещений: строка на событие с меткой времени сэмпла, файл
+// дописывается и сбрасывается после каждой строки, чтобы его можно было читать tail -f
+class AlertLog
+{
+public:
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString errorString() const { return file.errorString(); }
+
+    bool write(const AlertEvent &event);
+
+private:
+    QFile file;
+};
+
+#endif // ALERTLOG_H
@@ -0,0 +1,75 @@
+#include "anomalydetector.h"
+#include <cmath>
+
+void AnomalyDetector::add(double timeSec, double total, const QVector<double> &coreUsages)
+{
+    const int needed = 1 + coreUsages.size();
+    if (states.size() < needed) {
+        states.resize(needed);
+    }
+
+    update(states[0], total, timeSec, 0);
+    for (int core = 0; core < coreUsages.size(); ++core) {
+        update(states[core + 1], coreUsages[core], timeSec, core + 1);
+    }
+}
+
+void AnomalyDetector::update(SeriesState &state, double value, double timeSec, int series)
+{
+    // Ядро offline
+    if (std::isnan(value)) {
+        return;
+    }
+
+    const float x = static_cast<float>(value);
+    const float diff = x - state.mean;
+    if (state.samples < WARMUP_SAMPLES) {
+        // Пока норма не накоплена, среднее и дисперсия считаются точно (Уэлфорд)
+        ++state.samples;
+        state.mean += diff / state.samples;
+        state.variance += (diff * (x - state.mean) - state.variance) / state.samples;
+        return;
+    }
+
+    // Сравнение квадратов: sqrt на сэмпл не нужен
+    const float deviation2 = diff * diff;
+    const float limit = state.anomalous ? Z_THRESHOLD / 2.0f : Z_THRESHOLD;
+    const float minDeviation = state.anomalous ? MIN_DEVIATION / 2.0f : MIN_DEVIATION;
+    const bool outside = deviation2 > limit * limit * state.variance
+                         && deviation2 >= minDeviation * minDeviation;
+
+    if (outside && !state.anomalous) {
+        state.anomalous = true;
+        ++state.episodes;
+        ++episodes;
+
+        AnomalyMark mark;
+        mark.timeSec = timeSec;
+        mark.value = x;
+        mark.series = series;
+        if (marks.size() < MAX_MARKS) {
+            marks.append(mark);
+        } else {
+            marks[marksHead] = mark;
+            marksHead = (marksHead + 1) % MAX_MARKS;
+        }
+    } else if (!outside) {
+        state.anomalous = false;
+    }
+
+    // Экспоненциально взвешенные среднее и дисперсия
+    const float increment = ALPHA * diff;
+    state.mean += increment;
+    state.variance = (1.0f - ALPHA) * (state.variance + diff * increment);
+}
+
+void AnomalyDetector::copyMarks(double minTimeSec, QVector<AnomalyMark> &out) const
+{
+    out.clear();
+    for (int i = 0; i < marks.size(); ++i) {
+        const AnomalyMark &mark = marks[(marksHead + i) % marks.size()];
+        if (mark.timeSec >= minTimeSec) {
+            out.append(mark);
+        }
+    }
+}
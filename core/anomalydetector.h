@@ -0,0 +1,61 @@
+#ifndef ANOMALYDETECTOR_H
+#define ANOMALYDETECTOR_H
+
+#include <QVector>
+
+// Отметка начала аномалии для графика
+struct AnomalyMark
+{
+    double timeSec = 0.0;
+    float value = 0.0f;  // значение, на котором обнаружено отклонение
+    int series = 0;      // 0 — общая загрузка, i + 1 — ядро i
+};
+
+// Онлайн-детектор отклонений загрузки от нормы ряда. Ряд 0 — общая загрузка,
+// ряд i + 1 — ядро i. Норма — экспоненциально взвешенные среднее и дисперсия:
+// на сэмпл несколько умножений на ряд без sqrt, состояние — 16 байт на ряд.
+// Аномалия начинается, когда отклонение больше Z_THRESHOLD сигм и не меньше
+// MIN_DEVIATION процентов, и заканчивается, когда отклонение падает вдвое
+// (гистерезис). Считаются эпизоды, а не сэмплы; отметки последних эпизодов
+// хранятся в кольце для графика. Норма продолжает обновляться и во время
+// аномалии, так что длительный сдвиг уровня со временем становится новой нормой.
+class AnomalyDetector
+{
+public:
+    static constexpr int MAX_MARKS = 256;
+
+    void add(double timeSec, double total, const QVector<double> &coreUsages);
+
+    // Эпизодов с начала приема; на ряд — anomalyCount(series)
+    quint32 anomalyCount() const { return episodes; }
+    quint32 anomalyCount(int series) const { return series < states.size() ? states[series].episodes : 0; }
+    bool isAnomalous(int series) const { return series < states.size() && states[series].anomalous; }
+
+    // Отметки начала аномалий не старше minTimeSec, от старых к новым
+    void copyMarks(double minTimeSec, QVector<AnomalyMark> &out) const;
+
+private:
+    struct SeriesState
+    {
+        float mean = 0.0f;
+        float variance = 0.0f;
+        quint16 samples = 0;    // до WARMUP_SAMPLES — накопление нормы, без проверок
+        bool anomalous = false;
+        quint32 episodes = 0;
+    };
+
+    void update(SeriesState &state, double value, double timeSec, int series);
+
+    // Полураспад нормы ~300 сэмплов (5 минут при одном сэмпле в секунду)
+    static constexpr float ALPHA = 0.0023f;
+    static constexpr quint16 WARMUP_SAMPLES = 60;
+    static constexpr float Z_THRESHOLD = 4.0f;
+    static constexpr float MIN_DEVIATION = 20.0f;
+
+    QVector<SeriesState> states;
+    QVector<AnomalyMark> marks;  // кольцо из MAX_MARKS
+    int marksHead = 0;
+    quint32 episodes = 0;
+};
+
+#endif // ANOMALYDETECTOR_H
@@ -0,0 +1,117 @@
+#include "capturefile.h"
+#include <cstring>
+
+namespace {
+
+bool fail(QString *errorString, const QString &message)
+{
+    if (errorString) {
+        *errorString = message;
+    }
+    return false;
+}
+
+} // namespace
+
+bool CaptureWriter::open(const QString &path, QString *errorString)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return fail(errorString, file.errorString());
+    }
+
+    stream.setDevice(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+    stream.writeRawData(CaptureFormat::MAGIC, CaptureFormat::MAGIC_SIZE);
+    stream << CaptureFormat::VERSION;
+    records = 0;
+    return stream.status() == QDataStream::Ok || fail(errorString, file.errorString());
+}
+
+void CaptureWriter::close()
+{
+    stream.setDevice(nullptr);
+    file.close();
+}
+
+bool CaptureWriter::write(qint64 receiveTimeMs, const QString &sender, const QByteArray &data)
+{
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    const QByteArray senderUtf8 = sender.toUtf8();
+    if (senderUtf8.size() > 0xFFFF || data.size() > 0xFFFF) {
+        return false;
+    }
+
+    stream << receiveTimeMs
+           << static_cast<quint16>(senderUtf8.size())
+           << static_cast<quint16>(data.size());
+    stream.writeRawData(senderUtf8.constData(), senderUtf8.size());
+    stream.writeRawData(data.constData(), data.size());
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+    ++records;
+    return true;
+}
+
+bool CaptureReader::open(const QString &path, QString *errorString)
+{
+    error.clear();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return fail(errorString, file.errorString());
+    }
+
+    stream.setDevice(&file);
+    stream.setByteOrder(QDataStream::BigEndian);
+
+    char magic[CaptureFormat::MAGIC_SIZE];
+    quint16 version = 0;
+    if (stream.readRawData(magic, CaptureFormat::MAGIC_SIZE) != CaptureFormat::MAGIC_SIZE
+        || memcmp(magic, CaptureFormat::MAGIC, CaptureFormat::MAGIC_SIZE) != 0) {
+        close();
+        return fail(errorString, "Not a cpu-server capture file");
+    }
+
+    stream >> version;
+    if (version != CaptureFormat::VERSION) {
+        close();
+        return fail(errorString, QString("Unsupported capture version %1").arg(version));
+    }
+    return true;
+}
+
+void CaptureReader::close()
+{
+    stream.setDevice(nullptr);
+    file.close();
+}
+
+bool CaptureReader::readNext(CaptureRecord &record)
+{
+    if (!file.isOpen() || hasError() || stream.atEnd()) {
+        return false;
+    }
+
+    const qint64 offset = file.pos();
+    quint16 senderSize = 0;
+    quint16 dataSize = 0;
+    stream >> record.receiveTimeMs >> senderSize >> dataSize;
+    if (stream.status() != QDataStream::Ok) {
+        return fail(&error, QString("Truncated record header at offset %1").arg(offset));
+    }
+
+    QByteArray senderUtf8(senderSize, Qt::Uninitialized);
+    record.data.resize(dataSize);
+    if (stream.readRawData(senderUtf8.data(), senderSize) != senderSize
+        || stream.readRawData(record.data.data(), dataSize) != dataSize) {
+        return fail(&error, QString("Truncated record at offset %1: expected %2 bytes")
+                                .arg(offset).arg(CaptureFormat::RECORD_HEADER_SIZE + senderSize + dataSize));
+    }
+
+    record.sender = QString::fromUtf8(senderUtf8);
+    return true;
+}
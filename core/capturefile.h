@@ -0,0 +1,65 @@
+#ifndef CAPTUREFILE_H
+#define CAPTUREFILE_H
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QFile>
+#include <QString>
+
+// Одна записанная датаграмма
+struct CaptureRecord
+{
+    qint64 receiveTimeMs = 0;  // время приема, мс с начала эпохи
+    QString sender;            // адрес:порт отправителя
+    QByteArray data;           // датаграмма без изменений
+};
+
+// Формат файла записи (big-endian):
+//   заголовок: "CPUCAP" quint16 версия
+//   запись:    qint64 receiveTimeMs, quint16 длина sender, quint16 длина data,
+//              sender (UTF-8), data
+class CaptureWriter
+{
+public:
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+    QString errorString() const { return file.errorString(); }
+
+    bool write(qint64 receiveTimeMs, const QString &sender, const QByteArray &data);
+    quint64 recordCount() const { return records; }
+
+private:
+    QFile file;
+    QDataStream stream;
+    quint64 records = 0;
+};
+
+class CaptureReader
+{
+public:
+    bool open(const QString &path, QString *errorString = nullptr);
+    void close();
+
+    // Читает следующую запись; false — конец файла или поврежденная запись.
+    // Их различает hasError(): обрезанная в конце файла запись — ошибка, а не конец
+    bool readNext(CaptureRecord &record);
+    bool hasError() const { return !error.isEmpty(); }
+    QString errorString() const { return error; }
+
+private:
+    QFile file;
+    QDataStream stream;
+    QString error;
+};
+
+namespace CaptureFormat
+{
+    constexpr char MAGIC[] = "CPUCAP";
+    constexpr int MAGIC_SIZE = 6;
+    constexpr quint16 VERSION = 1;
+    // receiveTimeMs и две длины перед sender и data
+    constexpr int RECORD_HEADER_SIZE = 8 + 2 + 2;
+}
+
+#endif // CAPTUREFILE_H
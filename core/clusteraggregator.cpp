@@ -0,0 +1,77 @@
+#include "clusteraggregator.h"
+#include <cmath>
+
+ClusterAggregator::ClusterAggregator(double windowSec, double bucketSec)
+    : buckets(qMax(1, static_cast<int>(std::ceil(windowSec / bucketSec))))
+    , bucketSec(bucketSec)
+{
+}
+
+void ClusterAggregator::add(double timeSec, double totalUsage, HostContribution &host)
+{
+    const qint64 index = static_cast<qint64>(std::floor(timeSec / bucketSec));
+    const qint64 size = buckets.size();
+
+    if (index == host.bucket) {
+        host.sum += totalUsage;
+        ++host.count;
+        return;
+    }
+    // Опоздавший сэмпл хоста в уже закрытую им корзину. Скачок часов хоста
+    // назад дальше окна сбрасывает его корзину
+    if (index < host.bucket && index > host.bucket - size) {
+        return;
+    }
+
+    // Хост перешел в другую корзину — прежняя для него закрыта
+    newest = qMax(newest, index);
+    fold(host);
+    host.bucket = index;
+    host.sum = totalUsage;
+    host.count = 1;
+}
+
+void ClusterAggregator::fold(const HostContribution &host)
+{
+    if (host.count == 0) {
+        return;
+    }
+    // Опоздавшее значение попадает в свою корзину, если она еще в кольце
+    const qint64 size = buckets.size();
+    if (host.bucket <= newest - size) {
+        ++late;
+        return;
+    }
+
+    Bucket &bucket = buckets[static_cast<int>(host.bucket % size)];
+    if (bucket.index != host.bucket) {
+        bucket.index = host.bucket;
+        bucket.sketch.clear();
+    }
+    bucket.sketch.add(host.sum / host.count);
+}
+
+void ClusterAggregator::copySeries(QVector<double> &times, QVector<double> &mean,
+                                   QVector<double> &max, QVector<double> &p95) const
+{
+    times.clear();
+    mean.clear();
+    max.clear();
+    p95.clear();
+    if (newest < 0) {
+        return;
+    }
+
+    const qint64 size = buckets.size();
+    for (qint64 index = qMax<qint64>(0, newest - size + 1); index <= newest; ++index) {
+        const Bucket &bucket = buckets[static_cast<int>(index % size)];
+        // Слот мог остаться от старого оборота кольца, если в корзину ничего не пришло
+        if (bucket.index != index || bucket.sketch.isEmpty()) {
+            continue;
+        }
+        times.append((index + 0.5) * bucketSec);
+        mean.append(bucket.sketch.mean());
+        max.append(bucket.sketch.max());
+        p95.append(bucket.sketch.quantile(0.95));
+    }
+}
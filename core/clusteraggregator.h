@@ -0,0 +1,57 @@
+#ifndef CLUSTERAGGREGATOR_H
+#define CLUSTERAGGREGATOR_H
+
+#include "usagesketch.h"
+#include <QVector>
+
+// Агрегаты общей загрузки по всем хостам: сэмплы раскладываются по корзинам
+// времени и сворачиваются в эскиз UsageSketch корзины. Сырые значения хостов
+// не хранятся — на корзину приходится один эскиз постоянного размера,
+// из которого берутся среднее, максимум и p95. От хоста в корзину идет одно
+// значение — среднее его сэмплов за корзину, — чтобы хост с частыми сэмплами
+// не перевешивал остальных.
+class ClusterAggregator
+{
+public:
+    // Вклад хоста в его текущую корзину; хранится у хоста. Сэмплы копятся здесь,
+    // а в эскиз корзины их среднее попадает, когда хост переходит в более позднюю
+    // корзину: эскиз не умеет заменять уже внесенное значение
+    struct HostContribution
+    {
+        qint64 bucket = -1;
+        double sum = 0.0;
+        int count = 0;
+    };
+
+    // windowSec — сколько секунд истории держит кольцо корзин
+    explicit ClusterAggregator(double windowSec, double bucketSec = 1.0);
+
+    // Сэмпл хоста в более раннюю корзину окна, чем текущая у хоста, пропускается
+    void add(double timeSec, double totalUsage, HostContribution &host);
+
+    bool isEmpty() const { return newest < 0; }
+    double bucketSeconds() const { return bucketSec; }
+    // Значения хостов для корзин, уже вытесненных из кольца, отбрасываются
+    quint64 droppedLate() const { return late; }
+
+    // Ряды по непустым корзинам от старых к новым; время — середина корзины
+    void copySeries(QVector<double> &times, QVector<double> &mean,
+                    QVector<double> &max, QVector<double> &p95) const;
+
+private:
+    // Вносит среднее вклада хоста в эскиз его корзины
+    void fold(const HostContribution &host);
+
+    struct Bucket
+    {
+        qint64 index = -1;
+        UsageSketch sketch;
+    };
+
+    QVector<Bucket> buckets;  // кольцо: корзина i лежит в слоте i % size
+    double bucketSec;
+    qint64 newest = -1;
+    quint64 late = 0;
+};
+
+#endif // CLUSTERAGGREGATOR_H
@@ -0,0 +1,151 @@
+#include "cpuaggregates.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// До этого числа ядер online Джини считается точно, сортировкой копии в буфере на стеке
+// (типичные 4..64 ядра сортируются быстрее, чем заполняются корзины). Выше — проходом
+// подсчетом по GINI_BINS корзинам, погрешность относительно сортировки меньше 1e-3
+constexpr int GINI_SORT_MAX_CORES = 128;
+constexpr int GINI_BINS = 256;
+
+// Σ(i·x_i) по значениям в порядке возрастания, i с 1
+double sortedWeightedSum(const double *data, int n, int count)
+{
+    double sorted[GINI_SORT_MAX_CORES];
+    int size = 0;
+    for (int core = 0; core < n; ++core) {
+        if (data[core] == data[core]) {
+            sorted[size++] = data[core];
+        }
+    }
+    std::sort(sorted, sorted + size);
+    Q_ASSERT(size == count);
+    double weighted = 0.0;
+    for (int i = 0; i < size; ++i) {
+        weighted += (i + 1) * sorted[i];
+    }
+    return weighted;
+}
+
+// То же по корзинам 0..max: значениям корзины приписывается средний ранг. Джини не
+// зависит от масштаба, поэтому корзины делят 0..max сэмпла, а не 0..100%
+double binnedWeightedSum(const double *data, int n, double max)
+{
+    int binCount[GINI_BINS] = {};
+    double binSum[GINI_BINS] = {};
+    const double binScale = GINI_BINS / max;
+    for (int core = 0; core < n; ++core) {
+        const double value = data[core];
+        if (value == value) {
+            const int bin = qBound(0, static_cast<int>(value * binScale), GINI_BINS - 1);
+            ++binCount[bin];
+            binSum[bin] += value;
+        }
+    }
+    double weighted = 0.0;
+    int rank = 0;
+    for (int bin = 0; bin < GINI_BINS; ++bin) {
+        weighted += binSum[bin] * (rank + (binCount[bin] + 1) / 2.0);
+        rank += binCount[bin];
+    }
+    return weighted;
+}
+
+} // namespace
+
+double CpuAggregates::averageUsage(const QVector<double> &coreUsages)
+{
+    double sum = 0.0;
+    int online = 0;
+    for (double usage : coreUsages) {
+        if (!std::isnan(usage)) {
+            sum += usage;
+            ++online;
+        }
+    }
+    return online > 0 ? sum / online : 0.0;
+}
+
+double CpuAggregates::maxUsage(const QVector<double> &coreUsages)
+{
+    double result = 0.0;
+    for (double usage : coreUsages) {
+        // qMax с NaN во втором аргументе возвращает первый
+        result = qMax(result, usage);
+    }
+    return result;
+}
+
+CoreStats CpuAggregates::coreStats(const QVector<double> &coreUsages)
+{
+    constexpr int LANES = 4;
+    const double *data = coreUsages.constData();
+    const int n = coreUsages.size();
+
+    // Независимые накопители по дорожкам и тело без ветвлений: зависимостей
+    // между итерациями нет, и компилятор сворачивает цикл в SIMD
+    double sum[LANES] = {};
+    double sumSq[LANES] = {};
+    double max[LANES] = {};
+    int online[LANES] = {};
+    int i = 0;
+    for (; i + LANES <= n; i += LANES) {
+        for (int k = 0; k < LANES; ++k) {
+            const double value = data[i + k];
+            const bool on = value == value;  // NaN — ядро offline
+            const double x = on ? value : 0.0;
+            sum[k] += x;
+            sumSq[k] += x * x;
+            max[k] = x > max[k] ? x : max[k];
+            online[k] += on;
+        }
+    }
+    for (; i < n; ++i) {
+        const double value = data[i];
+        const bool on = value == value;
+        const double x = on ? value : 0.0;
+        sum[0] += x;
+        sumSq[0] += x * x;
+        max[0] = x > max[0] ? x : max[0];
+        online[0] += on;
+    }
+
+    CoreStats stats;
+    double totalSum = 0.0;
+    double totalSumSq = 0.0;
+    for (int k = 0; k < LANES; ++k) {
+        totalSum += sum[k];
+        totalSumSq += sumSq[k];
+        stats.max = qMax(stats.max, max[k]);
+        stats.online += online[k];
+    }
+    if (stats.online == 0) {
+        return stats;
+    }
+
+    const int count = stats.online;
+    stats.mean = totalSum / count;
+    CoreImbalance &imbalance = stats.imbalance;
+    imbalance.spread = stats.max - stats.mean;
+    imbalance.stddev = std::sqrt(qMax(0.0, totalSumSq / count - stats.mean * stats.mean));
+    for (int core = 0; core < n; ++core) {
+        if (data[core] == stats.max) {
+            imbalance.hottestCore = core;
+            break;
+        }
+    }
+
+    // Джини по значениям в порядке возрастания: G = 2·Σ(i·x_i) / (n·Σx) − (n + 1) / n,
+    // умноженный на n / (n − 1), чтобы максимум был 1 при любом числе ядер
+    if (count < 2 || totalSum <= 0.0) {
+        imbalance.gini = 0.0;
+        return stats;
+    }
+    const double weighted = count <= GINI_SORT_MAX_CORES ? sortedWeightedSum(data, n, count)
+                                                         : binnedWeightedSum(data, n, stats.max);
+    const double gini = 2.0 * weighted / (count * totalSum) - (count + 1.0) / count;
+    imbalance.gini = qBound(0.0, gini * count / (count - 1.0), 1.0);
+    return stats;
+}
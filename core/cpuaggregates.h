@@ -0,0 +1,40 @@
+#ifndef CPUAGGREGATES_H
+#define CPUAGGREGATES_H
+
+#include <QVector>
+#include <cmath>
+
+// Неравномерность загрузки по ядрам online: хост с 20% общей загрузки может
+// упираться в одно насыщенное ядро, что среднее скрывает
+struct CoreImbalance
+{
+    double spread = std::nan("");  // максимум минус среднее, процентные пункты
+    double stddev = std::nan("");  // стандартное отклонение по ядрам
+    double gini = std::nan("");    // Джини, нормированный на число ядер: 0 — поровну, 1 — все на одном
+    int hottestCore = -1;
+};
+
+// Среднее, максимум и неравномерность по ядрам сэмпла
+struct CoreStats
+{
+    int online = 0;
+    double mean = 0.0;   // 0, если ядер online нет
+    double max = 0.0;
+    CoreImbalance imbalance;
+};
+
+namespace CpuAggregates
+{
+    // Средняя загрузка по ядрам online (NaN — ядро отключено); 0, если таких нет
+    double averageUsage(const QVector<double> &coreUsages);
+
+    // Максимальная загрузка по ядрам online; 0, если таких нет
+    double maxUsage(const QVector<double> &coreUsages);
+
+    // Все показатели сэмпла: сумма, квадраты и максимум — одним проходом
+    // без ветвлений. Джини до 128 ядер online точный (сортировка копии на стеке),
+    // больше — проходом подсчетом по корзинам. Память не выделяется
+    CoreStats coreStats(const QVector<double> &coreUsages);
+}
+
+#endif // CPUAGGREGATES_H
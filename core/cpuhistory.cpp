@@ -0,0 +1,254 @@
+#include "cpuhistory.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+const double NaN = std::numeric_limits<double>::quiet_NaN();
+}
+
+CpuHistory::CpuHistory(int capacity)
+    : cap(capacity)
+    , times(capacity, 0.0)
+    , totals(capacity, NaN)
+{
+    for (QVector<double> &column : imbalance) {
+        column.fill(NaN, capacity);
+    }
+}
+
+bool CpuHistory::updateCoreSet(const QVector<double> &coreUsages)
+{
+    bool changed = false;
+
+    // Новые ядра: добавляем только их колонки, остальная история не копируется
+    while (cores.size() < coreUsages.size()) {
+        cores.append(QVector<double>(cap, NaN));
+        online.append(false);
+        if (hasDerived()) {
+            addDerivedColumn();
+        }
+        for (int c = 0; c < MetricChannels::COUNT; ++c) {
+            if (!channelMeans[c].isEmpty()) {
+                channelCores[c].append(QVector<double>(cap, NaN));
+            }
+        }
+        changed = true;
+    }
+
+    onlineCount = 0;
+    for (int i = 0; i < cores.size(); ++i) {
+        const bool isOnline = i < coreUsages.size() && !std::isnan(coreUsages[i]);
+        if (online[i] != isOnline) {
+            online[i] = isOnline;
+            changed = true;
+        }
+        if (isOnline) {
+            ++onlineCount;
+        }
+    }
+
+    return changed;
+}
+
+int CpuHistory::advance()
+{
+    if (count < cap) {
+        return physicalIndex(count++);
+    }
+
+    // Буфер заполнен: новая точка занимает место самой старой
+    int slot = head;
+    head = head + 1 == cap ? 0 : head + 1;
+    return slot;
+}
+
+void CpuHistory::append(double time, const QVector<double> &coreUsages, double totalUsage,
+                        const CoreImbalance &sampleImbalance)
+{
+    const int slot = advance();
+    times[slot] = time;
+    totals[slot] = totalUsage;
+    imbalance[static_cast<int>(Imbalance::Spread)][slot] = sampleImbalance.spread;
+    imbalance[static_cast<int>(Imbalance::StdDev)][slot] = sampleImbalance.stddev;
+    imbalance[static_cast<int>(Imbalance::Gini)][slot] = sampleImbalance.gini;
+    for (int i = 0; i < cores.size(); ++i) {
+        cores[i][slot] = i < coreUsages.size() ? coreUsages[i] : NaN;
+    }
+    for (int i = 0; i < derivedCores.size(); ++i) {
+        derivedCores[i][slot] = derivedFilters[i].add(time, cores[i][slot]);
+    }
+    // Ячейка кольца могла хранить каналы вытесненной точки
+    clearChannels(slot);
+}
+
+void CpuHistory::appendGap(double time)
+{
+    const int slot = advance();
+    times[slot] = time;
+    totals[slot] = NaN;
+    for (QVector<double> &column : imbalance) {
+        column[slot] = NaN;
+    }
+    for (int i = 0; i < cores.size(); ++i) {
+        cores[i][slot] = NaN;
+    }
+    for (int i = 0; i < derivedCores.size(); ++i) {
+        derivedCores[i][slot] = derivedFilters[i].add(time, NaN);
+    }
+    clearChannels(slot);
+}
+
+void CpuHistory::clearChannels(int slot)
+{
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        if (channelMeans[c].isEmpty()) {
+            continue;
+        }
+        channelMeans[c][slot] = NaN;
+        for (QVector<double> &column : channelCores[c]) {
+            column[slot] = NaN;
+        }
+    }
+}
+
+void CpuHistory::setChannels(const ChannelSample &channels)
+{
+    if (count == 0) {
+        return;
+    }
+    const int slot = physicalIndex(count - 1);
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        const QVector<double> &values = channels.perCore[c];
+        if (values.isEmpty()) {
+            continue;
+        }
+        if (channelMeans[c].isEmpty()) {
+            // Первый сэмпл с каналом: в прошлом у него NaN
+            channelMeans[c].fill(NaN, cap);
+            channelCores[c] = QVector<QVector<double>>(cores.size(), QVector<double>(cap, NaN));
+        }
+        QVector<QVector<double>> &columns = channelCores[c];
+        const int n = qMin(values.size(), columns.size());
+        for (int i = 0; i < n; ++i) {
+            columns[i][slot] = values[i];
+        }
+        channelMeans[c][slot] = CpuAggregates::averageUsage(values);
+    }
+}
+
+void CpuHistory::copyChannel(MetricChannel channel, int core, QVector<double> &values) const
+{
+    copyColumn(channelCores[static_cast<int>(channel)][core], values);
+}
+
+void CpuHistory::copyChannelMean(MetricChannel channel, QVector<double> &values) const
+{
+    copyColumn(channelMeans[static_cast<int>(channel)], values);
+}
+
+qint64 CpuHistory::memoryBytes() const
+{
+    qint64 columns = cores.size() + derivedCores.size() + 2 + IMBALANCE_METRICS;
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        if (!channelMeans[c].isEmpty()) {
+            columns += channelCores[c].size() + 1;
+        }
+    }
+    return static_cast<qint64>(cap) * columns * sizeof(double) + online.size();
+}
+
+void CpuHistory::addDerivedColumn()
+{
+    derivedCores.append(QVector<double>(cap, NaN));
+    derivedFilters.append(DerivedFilter(derivedSpec));
+}
+
+void CpuHistory::setDerived(const DerivedSpec &spec)
+{
+    if (spec == derivedSpec) {
+        return;
+    }
+    derivedSpec = spec;
+    derivedCores.clear();
+    derivedFilters.clear();
+    if (!hasDerived()) {
+        return;
+    }
+
+    // Однократное заполнение по накопленной истории; дальше — инкрементально в append
+    for (int i = 0; i < cores.size(); ++i) {
+        addDerivedColumn();
+        for (int index = 0; index < count; ++index) {
+            const int slot = physicalIndex(index);
+            derivedCores[i][slot] = derivedFilters[i].add(times[slot], cores[i][slot]);
+        }
+    }
+}
+
+void CpuHistory::copyDerivedCore(int core, QVector<double> &values) const
+{
+    copyColumn(derivedCores[core], values);
+}
+
+void CpuHistory::copyColumn(const QVector<double> &column, QVector<double> &values) const
+{
+    values.resize(count);
+    // Не более двух непрерывных кусков кольца
+    const int firstPart = qMin(count, cap - head);
+    std::copy(column.cbegin() + head, column.cbegin() + head + firstPart, values.begin());
+    std::copy(column.cbegin(), column.cbegin() + (count - firstPart), values.begin() + firstPart);
+}
+
+void CpuHistory::copyTimes(QVector<double> &keys) const
+{
+    copyColumn(times, keys);
+}
+
+void CpuHistory::copyTotal(QVector<double> &values) const
+{
+    copyColumn(totals, values);
+}
+
+void CpuHistory::copyCore(int core, QVector<double> &values) const
+{
+    copyColumn(cores[core], values);
+}
+
+void CpuHistory::copyImbalance(Imbalance metric, QVector<double> &values) const
+{
+    copyColumn(imbalance[static_cast<int>(metric)], values);
+}
+
+int CpuHistory::firstRowAfter(double time, int limit) const
+{
+    int first = count;
+    while (first > 0 && !(timeAt(first - 1) <= time)) {
+        if (count - first >= limit) {
+            return -1;
+        }
+        --first;
+    }
+    return first;
+}
+
+double CpuHistory::maxValueSince(double minTime) const
+{
+    double yMax = 0.0;
+
+    // Идем от новых точек к старым, пока они попадают в видимое окно
+    for (int index = count - 1; index >= 0; --index) {
+        const int slot = physicalIndex(index);
+        if (times[slot] < minTime) {
+            break;
+        }
+
+        // qMax с NaN во втором аргументе возвращает первый, поэтому разрывы пропускаются
+        yMax = qMax(yMax, totals[slot]);
+        for (int i = 0; i < cores.size(); ++i) {
+            yMax = qMax(yMax, cores[i][slot]);
+        }
+    }
+
+    return yMax;
+}
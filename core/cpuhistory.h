@@ -0,0 +1,135 @@
+#ifndef CPUHISTORY_H
+#define CPUHISTORY_H
+
+#include "cpuaggregates.h"
+#include "derivedseries.h"
+#include "metricchannel.h"
+#include <QVector>
+
+// История загрузки одного хоста: кольцевой буфер фиксированной емкости
+// с общей колонкой времени, колонкой общей загрузки и колонкой на каждое ядро.
+//
+// Набор ядер может меняться на ходу (hotplug, изменение числа vCPU):
+// новые колонки добавляются с NaN в прошлом, не трогая остальные, а ядра,
+// пропавшие из сэмпла, помечаются offline и продолжают получать NaN,
+// сохраняя накопленную историю. NaN в данных QCPGraph рисует как разрыв линии.
+// Показатели неравномерности по ядрам хранятся отдельными колонками.
+// Производный ряд ядер (сглаживание) включается setDerived(): колонки один раз
+// заполняются по накопленной истории, дальше обновляются при каждом append.
+// Расширенные каналы (user, sys, ..., частота) хранятся так же, колонка на ядро
+// и колонка среднего по ядрам на канал; колонки канала заводятся при первом
+// сэмпле, где он передан, так что непереданные каналы памяти не занимают.
+class CpuHistory
+{
+public:
+    enum class Imbalance {
+        Spread,
+        StdDev,
+        Gini
+    };
+
+    explicit CpuHistory(int capacity);
+
+    int capacity() const { return cap; }
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    // Число колонок ядер, включая offline
+    int coreCount() const { return cores.size(); }
+    bool isCoreOnline(int core) const { return online[core]; }
+    int onlineCoreCount() const { return onlineCount; }
+
+    // Приводит набор ядер в соответствие с сэмплом (NaN — ядро offline).
+    // Возвращает true, если набор колонок или их состояние изменились.
+    bool updateCoreSet(const QVector<double> &coreUsages);
+
+    // Добавляет точку; ядра, отсутствующие в coreUsages, получают NaN
+    void append(double time, const QVector<double> &coreUsages, double totalUsage,
+                const CoreImbalance &imbalance = CoreImbalance());
+    // Добавляет разрыв (NaN во всех колонках)
+    void appendGap(double time);
+
+    // Доступ по логическому индексу: 0 — самая старая точка
+    double timeAt(int index) const { return times[physicalIndex(index)]; }
+    double totalAt(int index) const { return totals[physicalIndex(index)]; }
+    double coreAt(int core, int index) const { return cores[core][physicalIndex(index)]; }
+    double imbalanceAt(Imbalance metric, int index) const
+    {
+        return imbalance[static_cast<int>(metric)][physicalIndex(index)];
+    }
+    double lastTime() const { return timeAt(count - 1); }
+    double lastTotal() const { return totalAt(count - 1); }
+
+    // Линеаризация кольца для QCPGraph::setData
+    void copyTimes(QVector<double> &keys) const;
+    void copyTotal(QVector<double> &values) const;
+    void copyCore(int core, QVector<double> &values) const;
+    void copyImbalance(Imbalance metric, QVector<double> &values) const;
+
+    // Включает производный ряд ядер (или выключает при неактивном spec)
+    // и пересчитывает его по всей истории
+    void setDerived(const DerivedSpec &spec);
+    const DerivedSpec &derived() const { return derivedSpec; }
+    bool hasDerived() const { return derivedSpec.isActive(); }
+    void copyDerivedCore(int core, QVector<double> &values) const;
+
+    // Записывает каналы последней точки; вызывается сразу после append
+    void setChannels(const ChannelSample &channels);
+    bool hasChannel(MetricChannel channel) const { return !channelMeans[static_cast<int>(channel)].isEmpty(); }
+    double channelAt(MetricChannel channel, int core, int index) const
+    {
+        return channelCores[static_cast<int>(channel)][core][physicalIndex(index)];
+    }
+    // Среднее канала по ядрам
+    double channelMeanAt(MetricChannel channel, int index) const
+    {
+        return channelMeans[static_cast<int>(channel)][physicalIndex(index)];
+    }
+    void copyChannel(MetricChannel channel, int core, QVector<double> &values) const;
+    void copyChannelMean(MetricChannel channel, QVector<double> &values) const;
+
+    // Память под колонки истории в байтах
+    qint64 memoryBytes() const;
+
+    // Максимум по всем колонкам среди точек не старше minTime
+    double maxValueSince(double minTime) const;
+
+    // Для инкрементальной отрисовки: индекс первой точки новее time (при NaN
+    // новыми считаются все). Поиск идет с конца и просматривает не больше limit
+    // точек, так что стоимость не зависит от длины истории; -1 — новых точек
+    // больше limit, и дешевле перерисовать все окно
+    int firstRowAfter(double time, int limit = MAX_INCREMENTAL_ROWS) const;
+    static constexpr int MAX_INCREMENTAL_ROWS = 64;
+
+private:
+    int physicalIndex(int index) const
+    {
+        int i = head + index;
+        return i >= cap ? i - cap : i;
+    }
+    // Индекс ячейки под новую точку; при заполненном буфере вытесняет самую старую
+    int advance();
+    void addDerivedColumn();
+    void clearChannels(int slot);
+    void copyColumn(const QVector<double> &column, QVector<double> &values) const;
+
+    static constexpr int IMBALANCE_METRICS = 3;
+
+    int cap;
+    int head = 0;   // физический индекс самой старой точки
+    int count = 0;
+
+    QVector<double> times;
+    QVector<double> totals;
+    QVector<double> imbalance[IMBALANCE_METRICS];
+    QVector<QVector<double>> cores;
+    QVector<bool> online;
+    DerivedSpec derivedSpec;
+    QVector<QVector<double>> derivedCores;
+    QVector<DerivedFilter> derivedFilters;
+    QVector<QVector<double>> channelCores[MetricChannels::COUNT];
+    QVector<double> channelMeans[MetricChannels::COUNT];
+    int onlineCount = 0;
+};
+
+#endif // CPUHISTORY_H
@@ -0,0 +1,202 @@
+#include "cpuingest.h"
+#include "cpuaggregates.h"
+#include "cpumonitorlog.h"
+#include "perfcounters.h"
+#include "tracing.h"
+
+CpuIngest::CpuIngest(int historyCapacity)
+    : historyCapacity(historyCapacity)
+    , clusterAggregates(CLUSTER_WINDOW_SEC)
+{
+}
+
+CpuIngest::~CpuIngest()
+{
+    qDeleteAll(hostList);
+}
+
+HostModel *CpuIngest::hostFor(const QString &id)
+{
+    HostModel *host = hostsById.value(id);
+    if (!host) {
+        host = new HostModel(id, historyCapacity);
+        hostsById.insert(id, host);
+        hostList.append(host);
+        qCInfo(cpuMonitor) << "New host:" << id;
+    }
+    return host;
+}
+
+void CpuIngest::reserveCoreRollups(HostModel *host, int coreCount)
+{
+    SketchRollup &rollup = host->rollup;
+    const int extra = coreCount - rollup.coreLimit();
+    if (extra <= 0) {
+        return;
+    }
+    // Новый хост получает ряды на все ядра или ни одного; добавленные hotplug'ом
+    // ядра — сколько осталось в бюджете
+    const int available = MAX_CORE_ROLLUP_SERIES - coreRollupSeries;
+    const int granted = rollup.tracksCores() ? qMin(extra, available) : (extra <= available ? extra : 0);
+    if (granted == 0) {
+        return;
+    }
+    rollup.setCoreLimit(rollup.coreLimit() + granted);
+    coreRollupSeries += granted;
+}
+
+qint64 CpuIngest::historyMemoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const HostModel *host : hostList) {
+        bytes += host->history.memoryBytes() + host->nodeHistory.memoryBytes();
+    }
+    return bytes;
+}
+
+qint64 CpuIngest::rollupMemoryBytes() const
+{
+    qint64 bytes = 0;
+    for (const HostModel *host : hostList) {
+        bytes += host->rollup.memoryBytes();
+    }
+    return bytes;
+}
+
+SequenceStats CpuIngest::sequenceStats() const
+{
+    SequenceStats total;
+    for (const HostModel *host : hostList) {
+        total += host->sequence.stats();
+    }
+    return total;
+}
+
+CpuIngest::Status CpuIngest::processDatagram(const QByteArray &data, const QString &sender,
+                                             qint64 receiveTimeMs, IngestResult &result)
+{
+    TRACE_SCOPE("CpuIngest::processDatagram");
+
+    PerfCounters &counters = PerfCounters::global();
+    const qint64 startNs = PerfCounters::nowNs();
+    const Status status = decodeDatagram(data, sender, receiveTimeMs, result);
+
+    PerfCounters::add(counters.datagramsReceived);
+    PerfCounters::add(counters.ingestNsTotal, PerfCounters::nowNs() - startNs);
+    PerfCounters::add(counters.ingestCount);
+    if (status == Status::Invalid) {
+        PerfCounters::add(counters.datagramsDropped);
+    } else if (status == Status::Accepted) {
+        PerfCounters::add(counters.samplesAccepted);
+    }
+    return status;
+}
+
+CpuIngest::Status CpuIngest::decodeDatagram(const QByteArray &data, const QString &sender,
+                                            qint64 receiveTimeMs, IngestResult &result)
+{
+    if (!CpuProtocol::parseDatagram(data, CpuProtocol::hostIdForSender(sender), parsed, &error)) {
+        return Status::Invalid;
+    }
+
+    if (parsed.fragmented) {
+        // Сэмпл хоста с большим числом ядер: ждем остальные фрагменты
+        const CpuSample *complete = fragmentAssembler.addFragment(parsed, receiveTimeMs);
+        if (!complete) {
+            return Status::Pending;
+        }
+        return processSample(*complete, receiveTimeMs, result);
+    }
+
+    return processSample(parsed, receiveTimeMs, result);
+}
+
+CpuIngest::Status CpuIngest::processSample(const CpuSample &sample, qint64 receiveTimeMs,
+                                           IngestResult &result)
+{
+    result = IngestResult();
+    result.sample = &sample;
+
+    // Проверка до учета Seq и до заведения хоста: отброшенный сэмпл не должен
+    // считаться принятым в статистике потерь
+    const CoreStats stats = CpuAggregates::coreStats(sample.coreUsages);
+    if (stats.online == 0) {
+        error = QString("No online cores in sample from %1").arg(sample.hostId);
+        return Status::Invalid;
+    }
+
+    HostModel *host = hostFor(sample.hostId);
+    result.host = host;
+
+    // Клиенты без Seq: принимаются как раньше, без учета потерь
+    if (sample.hasSequence) {
+        switch (host->sequence.update(sample.sequence)) {
+        case SequenceTracker::Result::Duplicate:
+        case SequenceTracker::Result::Reordered:
+            // Устаревший сэмпл не рисуем: на графике уже есть более новые точки
+            qCDebug(cpuMonitor) << "Stale datagram from" << sample.hostId << "seq" << sample.sequence;
+            return Status::Stale;
+        case SequenceTracker::Result::Gap:
+            qCDebug(cpuMonitor) << "Lost" << host->sequence.lastGapSize() << "datagrams from" << sample.hostId;
+            result.gapBefore = true;
+            break;
+        case SequenceTracker::Result::Restarted:
+            result.gapBefore = true;
+            break;
+        case SequenceTracker::Result::InOrder:
+            break;
+        }
+    }
+
+    // Число ядер может меняться на ходу (hotplug, изменение числа vCPU)
+    CpuHistory &history = host->history;
+    result.coreSetChanged = history.updateCoreSet(sample.coreUsages);
+    if (result.coreSetChanged) {
+        reserveCoreRollups(host, history.coreCount());
+    }
+    // Топология приходит не в каждом сэмпле: карта хоста действует до следующей
+    if (!sample.topology.isEmpty() && host->topology.update(sample.topology)) {
+        result.topologyChanged = true;
+        // Номера узлов могли измениться, старые колонки узлов несопоставимы с новыми
+        host->nodeHistory = CpuHistory(historyCapacity);
+        qCInfo(cpuMonitor) << "Topology of" << sample.hostId << ":"
+                           << host->topology.groupCount(TopologyMap::Level::Socket) << "sockets,"
+                           << host->topology.groupCount(TopologyMap::Level::Node) << "nodes,"
+                           << host->topology.groupCount(TopologyMap::Level::PhysicalCore) << "physical cores";
+    }
+
+    // Среднее и неравномерность по ядрам посчитаны при проверке сэмпла
+    result.totalUsage = stats.mean;
+    result.imbalance = stats.imbalance;
+
+    const double sampleTimeSec = receiveTimeMs / 1000.0;
+    // Потерянные датаграммы отмечаем точкой NaN: QCPGraph рисует на ней разрыв линии
+    const double gapTimeSec = history.isEmpty() ? 0.0 : (history.lastTime() + sampleTimeSec) / 2.0;
+    if (result.gapBefore && !history.isEmpty()) {
+        history.appendGap(gapTimeSec);
+    }
+    history.append(sampleTimeSec, sample.coreUsages, result.totalUsage, result.imbalance);
+    if (!sample.channels.isEmpty()) {
+        history.setChannels(sample.channels);
+    }
+    if (!host->topology.isEmpty()) {
+        // Агрегаты по узлам — по готовому индексу «ядро → узел», один проход по сэмплу
+        host->topology.aggregate(TopologyMap::Level::Node, sample.coreUsages, nodeUsages, nodeCounts);
+        CpuHistory &nodes = host->nodeHistory;
+        nodes.updateCoreSet(nodeUsages);
+        if (result.gapBefore && !nodes.isEmpty()) {
+            nodes.appendGap(gapTimeSec);
+        }
+        nodes.append(sampleTimeSec, nodeUsages, result.totalUsage);
+    }
+    host->rollup.add(sampleTimeSec, result.totalUsage, sample.coreUsages);
+    host->anomalies.add(sampleTimeSec, result.totalUsage, sample.coreUsages);
+    host->forecaster.add(sampleTimeSec, result.totalUsage);
+
+    host->lastSeenMs = receiveTimeMs;
+    host->lastTotal = result.totalUsage;
+    host->lastImbalance = result.imbalance;
+    fleetRanking.update(host->id, result.totalUsage, receiveTimeMs, host->anomalies.anomalyCount());
+    clusterAggregates.add(sampleTimeSec, result.totalUsage, host->cluster);
+    return Status::Accepted;
+}
@@ -0,0 +1,124 @@
+#ifndef CPUINGEST_H
+#define CPUINGEST_H
+
+#include "anomalydetector.h"
+#include "clusteraggregator.h"
+#include "cpuhistory.h"
+#include "cpuprotocol.h"
+#include "fleetranking.h"
+#include "fragmentassembler.h"
+#include "holtforecaster.h"
+#include "sequencetracker.h"
+#include "sketchrollup.h"
+#include "topologymap.h"
+#include <QHash>
+#include <QString>
+#include <QVector>
+
+// Состояние одного хоста: учет Seq, история загрузки, квантильные эскизы,
+// детектор аномалий, прогноз общей загрузки и топология ядер
+struct HostModel
+{
+    HostModel(const QString &id, int historyCapacity)
+        : id(id)
+        , history(historyCapacity)
+        , nodeHistory(0)
+    {
+    }
+
+    QString id;
+    SequenceTracker sequence;
+    CpuHistory history;
+    // Карта ядер из последней строки Topo: и средняя загрузка по NUMA-узлам
+    // (колонка на узел). История узлов заводится при первой карте.
+    TopologyMap topology;
+    CpuHistory nodeHistory;
+    SketchRollup rollup;
+    AnomalyDetector anomalies;
+    HoltForecaster forecaster;
+    qint64 lastSeenMs = 0;
+    double lastTotal = 0.0;
+    // Неравномерность последнего сэмпла, в том числе самое загруженное ядро
+    CoreImbalance lastImbalance;
+    // Текущая корзина агрегатов по кластеру и сэмплы хоста в ней
+    ClusterAggregator::HostContribution cluster;
+};
+
+// Результат приема одного сэмпла
+struct IngestResult
+{
+    HostModel *host = nullptr;
+    const CpuSample *sample = nullptr;  // действителен до следующего вызова
+    bool gapBefore = false;             // перед сэмплом вставлен разрыв (потери или перезапуск)
+    bool coreSetChanged = false;        // изменился набор ядер хоста
+    bool topologyChanged = false;       // пришла новая карта топологии
+    double totalUsage = 0.0;            // средняя загрузка по ядрам online
+    CoreImbalance imbalance;            // неравномерность загрузки по ядрам online
+};
+
+// Конвейер приема без зависимости от виджетов: разбор датаграмм, сборка фрагментов,
+// учет порядковых номеров и запись в историю хоста.
+class CpuIngest
+{
+public:
+    enum class Status {
+        Accepted,  // сэмпл добавлен в историю хоста
+        Pending,   // фрагмент принят, сэмпл еще не собран
+        Stale,     // дубликат или опоздавший сэмпл, отброшен
+        Invalid    // ошибка разбора, см. lastError()
+    };
+
+    explicit CpuIngest(int historyCapacity);
+    ~CpuIngest();
+
+    Status processDatagram(const QByteArray &data, const QString &sender,
+                           qint64 receiveTimeMs, IngestResult &result);
+    Status processSample(const CpuSample &sample, qint64 receiveTimeMs, IngestResult &result);
+
+    // Сбрасывает незавершенные сборки фрагментов старше таймаута
+    int expireFragments(qint64 nowMs) { return fragmentAssembler.expireStale(nowMs); }
+
+    HostModel *host(const QString &id) const { return hostsById.value(id); }
+    // Хосты в порядке появления
+    const QVector<HostModel*> &hosts() const { return hostList; }
+    // Ранжирование всех хостов по общей загрузке для обзора парка
+    const FleetRanking &fleet() const { return fleetRanking; }
+    // Среднее, максимум и p95 общей загрузки всех хостов по корзинам времени
+    const ClusterAggregator &cluster() const { return clusterAggregates; }
+
+    SequenceStats sequenceStats() const;
+    // Память, занятая историями всех хостов
+    qint64 historyMemoryBytes() const;
+    // Память квантильных эскизов всех хостов
+    qint64 rollupMemoryBytes() const;
+    quint64 incompleteSamples() const { return fragmentAssembler.droppedSamples(); }
+    const QString &lastError() const { return error; }
+
+private:
+    Q_DISABLE_COPY(CpuIngest)
+
+    HostModel *hostFor(const QString &id);
+    void reserveCoreRollups(HostModel *host, int coreCount);
+    Status decodeDatagram(const QByteArray &data, const QString &sender,
+                          qint64 receiveTimeMs, IngestResult &result);
+
+    // Бюджет рядов эскизов по ядрам на весь парк (до ~37 КБ на ряд за сутки):
+    // хост, чьи ядра в него не помещаются, ведет эскиз только общей загрузки
+    static constexpr int MAX_CORE_ROLLUP_SERIES = 1024;
+    // Окно агрегатов по кластеру — видимая часть графика
+    static constexpr double CLUSTER_WINDOW_SEC = 5 * 60.0;
+
+    int historyCapacity;
+    int coreRollupSeries = 0;
+    QHash<QString, HostModel*> hostsById;
+    QVector<HostModel*> hostList;
+    FragmentAssembler fragmentAssembler;
+    FleetRanking fleetRanking;
+    ClusterAggregator clusterAggregates;
+    CpuSample parsed;
+    QVector<double> nodeUsages;
+    QVector<int> nodeCounts;
+    QString error;
+};
+
+#endif // CPUINGEST_H
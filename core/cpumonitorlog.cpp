@@ -0,0 +1,4 @@
+#include "cpumonitorlog.h"
+
+// Категория логирования для отладки
+Q_LOGGING_CATEGORY(cpuMonitor, "app.cpumonitor")
@@ -0,0 +1,9 @@
+#ifndef CPUMONITORLOG_H
+#define CPUMONITORLOG_H
+
+#include <QLoggingCategory>
+
+// Категория логирования для отладки
+Q_DECLARE_LOGGING_CATEGORY(cpuMonitor)
+
+#endif // CPUMONITORLOG_H
@@ -0,0 +1,220 @@
+#include "cpuprotocol.h"
+#include "cpumonitorlog.h"
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStringList>
+#include <limits>
+
+namespace {
+
+bool fail(QString *errorString, const QString &message)
+{
+    if (errorString) {
+        *errorString = message;
+    }
+    return false;
+}
+
+bool parseFragmentHeader(const QString &value, FragmentHeader &header)
+{
+    static const QRegularExpression re(R"(^(\d+)\s+(\d+)/(\d+)\s+(\d+)\s+(\d+)$)");
+    QRegularExpressionMatch match = re.match(value);
+    if (!match.hasMatch()) {
+        return false;
+    }
+
+    header.sampleId = match.captured(1).toUInt();
+    header.index = match.captured(2).toInt();
+    header.count = match.captured(3).toInt();
+    header.coreOffset = match.captured(4).toInt();
+    header.coreCount = match.captured(5).toInt();
+
+    return header.count > 0 && header.count <= CpuProtocol::MAX_FRAGMENTS
+           && header.index < header.count
+           && header.coreCount > 0 && header.coreCount <= CpuProtocol::MAX_CORES
+           && header.coreOffset < header.coreCount;
+}
+
+// «0.1.7 0.1.7 ...»: сокет, NUMA-узел и физическое ядро каждого логического ядра
+bool parseTopology(const QString &value, QVector<CoreTopology> &topology)
+{
+    static const QRegularExpression re(R"(^(\d+)\.(\d+)\.(\d+)$)");
+    const QStringList tokens = value.split(' ', Qt::SkipEmptyParts);
+    if (tokens.isEmpty() || tokens.size() > CpuProtocol::MAX_CORES) {
+        return false;
+    }
+
+    topology.resize(tokens.size());
+    for (int i = 0; i < tokens.size(); ++i) {
+        const QRegularExpressionMatch match = re.match(tokens[i]);
+        if (!match.hasMatch()) {
+            return false;
+        }
+        topology[i].socket = match.captured(1).toInt();
+        topology[i].node = match.captured(2).toInt();
+        topology[i].physicalCore = match.captured(3).toInt();
+    }
+    return true;
+}
+
+// Сколько разных имен неизвестных каналов запоминать для предупреждений:
+// имена приходят из сети, и множество не должно расти без границ
+constexpr int MAX_REPORTED_CHANNELS = 64;
+
+// Неизвестный канал повторяется в каждой строке ядра каждого сэмпла, поэтому
+// предупреждение выдается один раз на имя. parseDatagram не привязан к потоку,
+// поэтому множество под мьютексом; известные каналы сюда не доходят
+void reportUnknownChannel(const QString &name)
+{
+    static QMutex mutex;
+    static QSet<QString> reported;
+
+    QMutexLocker locker(&mutex);
+    if (reported.size() >= MAX_REPORTED_CHANNELS || reported.contains(name)) {
+        return;
+    }
+    reported.insert(name);
+    if (reported.size() == MAX_REPORTED_CHANNELS) {
+        qCWarning(cpuMonitor) << "Unknown channel:" << name << "(further unknown channels are not reported)";
+    } else {
+        qCWarning(cpuMonitor) << "Unknown channel:" << name;
+    }
+}
+
+// Пары channel=value после загрузки ядра; неизвестные каналы пропускаются,
+// чтобы новые клиенты работали со старым сервером
+void parseChannels(const QString &line, int offset, int coreIdx, int coreCount, ChannelSample &channels)
+{
+    static const QRegularExpression channelRe(R"((\w+)=([\d.]+))");
+    QRegularExpressionMatchIterator it = channelRe.globalMatch(line, offset);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        MetricChannel channel;
+        if (!MetricChannels::fromName(match.captured(1), channel)) {
+            reportUnknownChannel(match.captured(1));
+            continue;
+        }
+        // Память под канал выделяется при первом значении в сэмпле
+        QVector<double> &values = channels.perCore[static_cast<int>(channel)];
+        if (values.isEmpty()) {
+            values.fill(std::numeric_limits<double>::quiet_NaN(), coreCount);
+        }
+        while (coreIdx >= values.size()) {
+            values.append(std::numeric_limits<double>::quiet_NaN());
+        }
+        values[coreIdx] = match.captured(2).toDouble();
+    }
+}
+
+} // namespace
+
+bool CpuProtocol::parseDatagram(const QByteArray &data, const QString &defaultHostId,
+                                CpuSample &sample, QString *errorString)
+{
+    // Регулярное выражение компилируется один раз, а не на каждую строку
+    static const QRegularExpression coreRe(R"(Core (\d+): ([\d.]+)%)");
+
+    QString text = QString::fromUtf8(data).trimmed();
+    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+
+    sample = CpuSample();
+    sample.hostId = defaultHostId;
+
+    // Необязательные заголовки перед строкой Total
+    int lineIdx = 0;
+    for (; lineIdx < lines.size(); ++lineIdx) {
+        const QString line = lines[lineIdx].trimmed();
+        if (line.startsWith("Host:")) {
+            sample.hostId = line.mid(5).trimmed();
+        } else if (line.startsWith("Seq:")) {
+            sample.sequence = line.mid(4).trimmed().toUInt(&sample.hasSequence);
+            if (!sample.hasSequence) {
+                return fail(errorString, QString("Invalid sequence number: %1").arg(line));
+            }
+        } else if (line.startsWith("Frag:")) {
+            if (!parseFragmentHeader(line.mid(5).trimmed(), sample.fragment)) {
+                return fail(errorString, QString("Invalid fragment header: %1").arg(line));
+            }
+            sample.fragmented = true;
+        } else if (line.startsWith("Topo:")) {
+            if (!parseTopology(line.mid(5).trimmed(), sample.topology)) {
+                return fail(errorString, QString("Invalid topology header: %1").arg(line.left(64)));
+            }
+        } else {
+            break;
+        }
+    }
+
+    if (lineIdx < lines.size() && lines[lineIdx].startsWith("Total:")) {
+        static const QRegularExpression totalRe(R"(Total:\s*([\d.]+)%)");
+        QRegularExpressionMatch match = totalRe.match(lines[lineIdx]);
+        sample.hasTotal = match.hasMatch();
+        sample.total = match.captured(1).toDouble();
+        ++lineIdx;
+    } else if (!sample.fragmented || sample.fragment.index == 0) {
+        return fail(errorString, "Invalid data format received");
+    }
+
+    // Сколько ядер описывает эта датаграмма
+    const int coreCount = lines.size() - lineIdx;
+    if (coreCount <= 0) {
+        return fail(errorString, "No core data received");
+    }
+
+    const int firstCore = sample.fragmented ? sample.fragment.coreOffset : 0;
+    const int maxCores = sample.fragmented ? sample.fragment.coreCount - firstCore : MAX_CORES;
+    if (coreCount > maxCores) {
+        return fail(errorString, QString("Too many cores in datagram: %1 > %2")
+                                     .arg(coreCount).arg(maxCores));
+    }
+
+    if (sample.topology.size() > maxCores) {
+        return fail(errorString, QString("Too many cores in topology: %1 > %2")
+                                     .arg(sample.topology.size()).arg(maxCores));
+    }
+
+    // Ядра, о которых клиент не сообщил (отключенные hotplug'ом), остаются NaN
+    sample.coreUsages.fill(std::numeric_limits<double>::quiet_NaN(), coreCount);
+
+    for (; lineIdx < lines.size(); ++lineIdx) {
+        const QString line = lines[lineIdx].trimmed();
+        QRegularExpressionMatch match = coreRe.match(line);
+        if (!match.hasMatch()) {
+            qCDebug(cpuMonitor) << "Failed to parse line:" << line;
+            continue;
+        }
+
+        // проверяем индекс ядра; номера могут идти с пропусками
+        int coreIdx = match.captured(1).toInt() - firstCore;
+        if (coreIdx < 0 || coreIdx >= maxCores) {
+            qCWarning(cpuMonitor) << "Invalid core index:" << match.captured(1);
+            continue;
+        }
+        while (coreIdx >= sample.coreUsages.size()) {
+            sample.coreUsages.append(std::numeric_limits<double>::quiet_NaN());
+        }
+
+        sample.coreUsages[coreIdx] = match.captured(2).toDouble();
+        if (match.capturedEnd(0) < line.size()) {
+            parseChannels(line, match.capturedEnd(0), coreIdx, sample.coreUsages.size(), sample.channels);
+        }
+    }
+
+    // Каналы выравниваются по числу ядер сэмпла
+    for (QVector<double> &values : sample.channels.perCore) {
+        while (!values.isEmpty() && values.size() < sample.coreUsages.size()) {
+            values.append(std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    return true;
+}
+
+QString CpuProtocol::hostIdForSender(const QString &sender)
+{
+    // Порт — после последнего двоеточия (в адресе IPv6 двоеточия тоже есть)
+    const int colon = sender.lastIndexOf(':');
+    return colon > 0 ? sender.left(colon) : sender;
+}
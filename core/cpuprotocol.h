@@ -0,0 +1,76 @@
+#ifndef CPUPROTOCOL_H
+#define CPUPROTOCOL_H
+
+#include "metricchannel.h"
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+// Заголовок фрагмента: один сэмпл хоста с большим числом ядер
+// передается несколькими датаграммами
+struct FragmentHeader
+{
+    quint32 sampleId = 0;
+    int index = 0;       // номер фрагмента, 0..count-1
+    int count = 1;       // всего фрагментов в сэмпле
+    int coreOffset = 0;  // номер первого ядра во фрагменте
+    int coreCount = 0;   // число ядер во всем сэмпле
+};
+
+// Размещение логического ядра: сокет, NUMA-узел и физическое ядро внутри сокета.
+// Логические ядра с одинаковыми socket и physicalCore — SMT-соседи. -1 — неизвестно.
+struct CoreTopology
+{
+    int socket = -1;
+    int node = -1;
+    int physicalCore = -1;
+
+    bool operator==(const CoreTopology &other) const
+    {
+        return socket == other.socket && node == other.node && physicalCore == other.physicalCore;
+    }
+    bool operator!=(const CoreTopology &other) const { return !(*this == other); }
+};
+
+// Разобранная датаграмма (или собранный из фрагментов сэмпл)
+struct CpuSample
+{
+    QString hostId;
+    bool hasSequence = false;
+    quint32 sequence = 0;
+    bool hasTotal = false;
+    double total = 0.0;
+    // Загрузка ядер (NaN — ядро не передано, т.е. offline);
+    // для фрагмента индекс отсчитывается от fragment.coreOffset
+    QVector<double> coreUsages;
+    // Топология ядер из строки Topo: (пусто — не передана); индексы как у coreUsages
+    QVector<CoreTopology> topology;
+    // Расширенные каналы по ядрам (user=, sys=, ... freq=); индексы как у coreUsages
+    ChannelSample channels;
+    bool fragmented = false;
+    FragmentHeader fragment;
+};
+
+namespace CpuProtocol
+{
+    // Ограничения сборки, защищающие от некорректных заголовков
+    constexpr int MAX_FRAGMENTS = 64;
+    constexpr int MAX_CORES = 4096;
+
+    // Разбирает текстовую датаграмму:
+    //   [Host: <имя>]
+    //   [Seq: <uint32>]
+    //   [Frag: <sampleId> <index>/<count> <coreOffset> <coreCount>]
+    //   [Topo: <socket>.<node>.<core> ...]  (по токену на ядро, начиная с первого ядра датаграммы)
+    //   Total: <float>%        (обязательна, кроме фрагментов с index > 0)
+    //   Core <N>: <float>% [<channel>=<float> ...]   (каналы — см. MetricChannel)
+    // defaultHostId используется, если в датаграмме нет строки Host:.
+    bool parseDatagram(const QByteArray &data, const QString &defaultHostId,
+                       CpuSample &sample, QString *errorString = nullptr);
+
+    // Хост по умолчанию для отправителя «адрес:порт» — только адрес: клиент, который
+    // перезапускается или меняет исходный порт, остается тем же хостом
+    QString hostIdForSender(const QString &sender);
+}
+
+#endif // CPUPROTOCOL_H
@@ -0,0 +1,125 @@
+#include "derivedseries.h"
+
+QString DerivedSpec::toString() const
+{
+    switch (kind) {
+    case Kind::Ema:
+        return QString("ema:%1").arg(param);
+    case Kind::Sma:
+        return QString("sma:%1").arg(param);
+    case Kind::MovingMax:
+        return QString("max:%1").arg(param);
+    case Kind::None:
+        break;
+    }
+    return "raw";
+}
+
+bool DerivedSpec::parse(const QString &text, DerivedSpec &spec, int maxParam, QString *errorString)
+{
+    spec = DerivedSpec();
+    const QString normalized = text.trimmed().toLower();
+    if (normalized == "raw" || normalized.isEmpty()) {
+        return true;
+    }
+
+    const int colon = normalized.indexOf(':');
+    const QString name = normalized.left(colon);
+    bool ok = colon > 0;
+    const double param = ok ? normalized.mid(colon + 1).toDouble(&ok) : 0.0;
+    if (name == "ema") {
+        spec.kind = Kind::Ema;
+    } else if (name == "sma") {
+        spec.kind = Kind::Sma;
+    } else if (name == "max") {
+        spec.kind = Kind::MovingMax;
+    } else {
+        ok = false;
+    }
+    // Окно SMA и максимума — целое число сэмплов, полураспад — с шагом 0.01 с.
+    // Сравнение «не больше maxParam» отсекает и inf, и nan
+    const double step = spec.kind == Kind::Ema ? HALF_LIFE_STEP_SEC : 1.0;
+    const double steps = param / step;
+    if (ok && (!(param > 0.0 && param <= maxParam) || std::abs(steps - std::round(steps)) > 1e-6)) {
+        ok = false;
+    }
+    if (!ok) {
+        spec = DerivedSpec();
+        if (errorString) {
+            *errorString = QString("Expected raw, ema:SECONDS (0.01..%1, step 0.01), "
+                                   "sma:SAMPLES or max:SAMPLES (1..%1): %2").arg(maxParam).arg(text);
+        }
+        return false;
+    }
+    spec.param = param;
+    return true;
+}
+
+DerivedFilter::DerivedFilter(const DerivedSpec &spec)
+    : spec(spec)
+{
+    if (spec.kind == DerivedSpec::Kind::Sma) {
+        window.fill(std::nan(""), spec.windowSamples());
+    }
+}
+
+double DerivedFilter::add(double timeSec, double value)
+{
+    switch (spec.kind) {
+    case DerivedSpec::Kind::Ema: {
+        if (std::isnan(value)) {
+            return value;
+        }
+        if (std::isnan(ema)) {
+            ema = value;
+        } else {
+            // Полураспад в секундах: alpha = 1 − 2^(−dt / halfLife)
+            const double alpha = 1.0 - std::exp2(-qMax(0.0, timeSec - emaTime) / spec.param);
+            ema += alpha * (value - ema);
+        }
+        emaTime = timeSec;
+        return ema;
+    }
+    case DerivedSpec::Kind::Sma: {
+        const double leaving = window[windowHead];
+        if (!std::isnan(leaving)) {
+            windowSum -= leaving;
+            --windowValid;
+        }
+        window[windowHead] = value;
+        windowHead = (windowHead + 1) % window.size();
+        if (std::isnan(value)) {
+            return value;
+        }
+        windowSum += value;
+        ++windowValid;
+        if (windowHead == 0) {
+            // Раз за оборот кольца сумма пересчитывается, чтобы не копилась ошибка
+            windowSum = 0.0;
+            for (double v : window) {
+                windowSum += std::isnan(v) ? 0.0 : v;
+            }
+        }
+        return windowSum / windowValid;
+    }
+    case DerivedSpec::Kind::MovingMax: {
+        const qint64 index = sampleIndex++;
+        const qint64 oldest = index - spec.windowSamples() + 1;
+        while (!maxQueue.empty() && maxQueue.front().first < oldest) {
+            maxQueue.pop_front();
+        }
+        if (std::isnan(value)) {
+            return value;
+        }
+        // Значения не больше нового уже никогда не станут максимумом
+        while (!maxQueue.empty() && maxQueue.back().second <= value) {
+            maxQueue.pop_back();
+        }
+        maxQueue.emplace_back(index, value);
+        return maxQueue.front().second;
+    }
+    case DerivedSpec::Kind::None:
+        break;
+    }
+    return value;
+}
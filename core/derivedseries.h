@@ -0,0 +1,68 @@
+#ifndef DERIVEDSERIES_H
+#define DERIVEDSERIES_H
+
+#include <QString>
+#include <QVector>
+#include <cmath>
+#include <deque>
+
+// Производный ряд для сглаживания линий ядер. Текстовая форма:
+//   ema:10   — экспоненциальное среднее с полураспадом 10 с
+//   sma:30   — простое скользящее среднее по 30 сэмплам
+//   max:60   — скользящий максимум по 60 сэмплам
+struct DerivedSpec
+{
+    enum class Kind {
+        None,
+        Ema,
+        Sma,
+        MovingMax
+    };
+
+    Kind kind = Kind::None;
+    double param = 0.0;  // EMA — полураспад в секундах, остальные — окно в сэмплах
+
+    // Шаг полураспада EMA: точнее его не показывает поле ввода
+    static constexpr double HALF_LIFE_STEP_SEC = 0.01;
+
+    bool isActive() const { return kind != Kind::None && param > 0.0; }
+    int windowSamples() const { return static_cast<int>(param); }
+    QString toString() const;
+    // maxParam — верхняя граница окна и полураспада (глубина истории в сэмплах):
+    // длиннее окна история все равно не хранит
+    static bool parse(const QString &text, DerivedSpec &spec, int maxParam, QString *errorString = nullptr);
+
+    bool operator==(const DerivedSpec &other) const { return kind == other.kind && param == other.param; }
+    bool operator!=(const DerivedSpec &other) const { return !(*this == other); }
+};
+
+// Инкрементальный фильтр одного ряда: O(1) на сэмпл (для скользящего
+// максимума — амортизированно, через монотонную очередь). NaN на входе
+// дает NaN на выходе и не попадает в окно.
+class DerivedFilter
+{
+public:
+    explicit DerivedFilter(const DerivedSpec &spec = DerivedSpec());
+
+    double add(double timeSec, double value);
+
+private:
+    DerivedSpec spec;
+
+    // EMA: коэффициент зависит от прошедшего времени, поэтому неравномерные сэмплы
+    // и разрывы учитываются правильно
+    double ema = std::nan("");
+    double emaTime = 0.0;
+
+    // SMA: кольцо последних значений окна и их сумма
+    QVector<double> window;
+    int windowHead = 0;
+    double windowSum = 0.0;
+    int windowValid = 0;
+
+    // Скользящий максимум: индексы и значения по убыванию значения
+    std::deque<std::pair<qint64, double>> maxQueue;
+    qint64 sampleIndex = 0;
+};
+
+#endif // DERIVEDSERIES_H
@@ -0,0 +1,74 @@
+#include "fleetranking.h"
+
+void FleetRanking::update(const QString &hostId, double total, qint64 timeMs, quint32 anomalies)
+{
+    auto found = indexById.constFind(hostId);
+    int index;
+    if (found == indexById.constEnd()) {
+        index = static_cast<int>(states.size());
+        indexById.insert(hostId, index);
+        states.emplace_back();
+        HostState &state = states.back();
+        state.summary.id = hostId;
+        state.byCurrent = byCurrent.insert({total, index}).first;
+        state.byWindow = byWindow.insert({total, index}).first;
+    } else {
+        index = found.value();
+    }
+
+    HostState &state = states[index];
+    HostSummary &summary = state.summary;
+
+    // Скользящая сумма по кольцу тренда; раз за оборот пересчитывается
+    // заново, чтобы не накапливалась ошибка округления
+    if (summary.trendCount == HostSummary::TREND_POINTS) {
+        summary.trendSum -= summary.trend[summary.trendHead];
+    } else {
+        ++summary.trendCount;
+    }
+    summary.trend[summary.trendHead] = static_cast<float>(total);
+    summary.trendSum += static_cast<float>(total);
+    summary.trendHead = (summary.trendHead + 1) % HostSummary::TREND_POINTS;
+    if (summary.trendHead == 0) {
+        summary.trendSum = 0.0;
+        for (int i = 0; i < summary.trendCount; ++i) {
+            summary.trendSum += summary.trend[i];
+        }
+    }
+
+    summary.current = total;
+    summary.windowAverage = summary.trendSum / summary.trendCount;
+    summary.lastSeenMs = timeMs;
+    summary.anomalies = anomalies;
+
+    reposition(byCurrent, state.byCurrent, summary.current, index);
+    reposition(byWindow, state.byWindow, summary.windowAverage, index);
+}
+
+void FleetRanking::reposition(RankSet &set, RankSet::iterator &it, double value, int host)
+{
+    if (it->value == value) {
+        return;
+    }
+    // Подсказка позиции: при небольшом изменении значение остается рядом
+    auto hint = set.erase(it);
+    it = set.insert(hint, {value, host});
+}
+
+const HostSummary *FleetRanking::summary(const QString &hostId) const
+{
+    auto found = indexById.constFind(hostId);
+    return found == indexById.constEnd() ? nullptr : &states[found.value()].summary;
+}
+
+void FleetRanking::ranked(Key key, QVector<const HostSummary*> &out, int limit) const
+{
+    const RankSet &set = key == Key::Current ? byCurrent : byWindow;
+    const int count = limit < 0 ? static_cast<int>(set.size()) : qMin(limit, static_cast<int>(set.size()));
+
+    out.resize(count);
+    auto it = set.begin();
+    for (int i = 0; i < count; ++i, ++it) {
+        out[i] = &states[it->host].summary;
+    }
+}
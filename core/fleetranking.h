@@ -0,0 +1,88 @@
+#ifndef FLEETRANKING_H
+#define FLEETRANKING_H
+
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include <deque>
+#include <set>
+
+// Компактная сводка хоста для обзора парка: без истории по ядрам,
+// только общая загрузка за последние TREND_POINTS сэмплов
+struct HostSummary
+{
+    static constexpr int TREND_POINTS = 60;
+
+    QString id;
+    double current = 0.0;
+    double windowAverage = 0.0;  // средняя общая загрузка за окно тренда
+    qint64 lastSeenMs = 0;
+    quint32 anomalies = 0;       // эпизодов аномалий по всем рядам хоста
+
+    int trendSize() const { return trendCount; }
+    // i = 0 — самое старое значение в окне
+    float trendAt(int i) const
+    {
+        return trend[(trendHead + TREND_POINTS - trendCount + i) % TREND_POINTS];
+    }
+
+private:
+    friend class FleetRanking;
+
+    float trend[TREND_POINTS] = {};
+    int trendHead = 0;   // куда запишется следующее значение
+    int trendCount = 0;
+    double trendSum = 0.0;
+};
+
+// Ранжирование хостов по текущей и средней за окно общей загрузке.
+// Оба порядка хранятся в упорядоченных множествах, у каждого хоста есть
+// итераторы на свои элементы, поэтому обновление стоит O(log N),
+// а первые K мест читаются за O(K) без сортировки.
+class FleetRanking
+{
+public:
+    enum class Key {
+        Current,
+        WindowAverage
+    };
+
+    void update(const QString &hostId, double total, qint64 timeMs, quint32 anomalies = 0);
+
+    int hostCount() const { return static_cast<int>(states.size()); }
+    const HostSummary *summary(const QString &hostId) const;
+
+    // Хосты по убыванию ключа; limit < 0 — все. Указатели действительны,
+    // пока жив объект: сводки не перемещаются при добавлении хостов.
+    void ranked(Key key, QVector<const HostSummary*> &out, int limit = -1) const;
+
+private:
+    struct RankEntry
+    {
+        double value;
+        int host;
+
+        bool operator<(const RankEntry &other) const
+        {
+            // По убыванию значения; при равенстве — по порядку появления
+            return value != other.value ? value > other.value : host < other.host;
+        }
+    };
+    using RankSet = std::set<RankEntry>;
+
+    struct HostState
+    {
+        HostSummary summary;
+        RankSet::iterator byCurrent;
+        RankSet::iterator byWindow;
+    };
+
+    static void reposition(RankSet &set, RankSet::iterator &it, double value, int host);
+
+    std::deque<HostState> states;  // deque не перемещает элементы при росте
+    QHash<QString, int> indexById;
+    RankSet byCurrent;
+    RankSet byWindow;
+};
+
+#endif // FLEETRANKING_H
@@ -0,0 +1,151 @@
+#include "fragmentassembler.h"
+#include "cpumonitorlog.h"
+#include <algorithm>
+#include <limits>
+
+FragmentAssembler::FragmentAssembler(qint64 timeoutMs)
+    : timeoutMs(timeoutMs)
+{
+}
+
+void FragmentAssembler::start(Assembly &assembly, const CpuSample &fragment, qint64 nowMs)
+{
+    const FragmentHeader &header = fragment.fragment;
+
+    assembly.active = true;
+    assembly.sampleId = header.sampleId;
+    assembly.fragmentCount = header.count;
+    assembly.receivedMask = 0;
+    assembly.startedMs = nowMs;
+
+    CpuSample &sample = assembly.sample;
+    sample.hostId = fragment.hostId;
+    sample.hasSequence = false;
+    sample.hasTotal = false;
+    sample.fragmented = false;
+    // resize() не освобождает память при уменьшении, поэтому буфер переиспользуется
+    sample.coreUsages.resize(header.coreCount);
+    std::fill(sample.coreUsages.begin(), sample.coreUsages.end(),
+              std::numeric_limits<double>::quiet_NaN());
+    sample.topology.clear();
+    sample.channels.clear();
+}
+
+bool FragmentAssembler::isLateDuplicate(const Assembly &assembly, const FragmentHeader &header,
+                                        qint64 nowMs) const
+{
+    // Повтор фрагмента уже собранного (или чуть более раннего) сэмпла иначе начал бы
+    // сборку, которая никогда не завершится и будет посчитана потерянной. Повторы
+    // приходят вскоре после сборки: через таймаут или при другой разбивке сэмпла
+    // (клиент перезапустился с другим числом ядер) близкий номер — уже новый сэмпл
+    if (!assembly.hasCompleted || nowMs - assembly.completedMs > timeoutMs
+        || header.count != assembly.fragmentCount
+        || header.coreCount != assembly.sample.coreUsages.size()) {
+        return false;
+    }
+    const qint32 age = static_cast<qint32>(assembly.completedId - header.sampleId);
+    return age >= 0 && age < LATE_SAMPLE_WINDOW;
+}
+
+const CpuSample *FragmentAssembler::addFragment(const CpuSample &fragment, qint64 nowMs)
+{
+    const FragmentHeader &header = fragment.fragment;
+    Assembly &assembly = assemblies[fragment.hostId];
+
+    if (assembly.active && assembly.sampleId != header.sampleId) {
+        // Пришел фрагмент другого сэмпла. Более новый вытесняет незавершенную сборку,
+        // опоздавший фрагмент старого сэмпла отбрасывается.
+        if (static_cast<qint32>(header.sampleId - assembly.sampleId) < 0) {
+            qCDebug(cpuMonitor) << "Late fragment of sample" << header.sampleId
+                                << "from" << fragment.hostId;
+            return nullptr;
+        }
+        qCDebug(cpuMonitor) << "Incomplete sample" << assembly.sampleId
+                            << "from" << fragment.hostId << "replaced";
+        ++dropped;
+        assembly.active = false;
+    }
+
+    if (!assembly.active && isLateDuplicate(assembly, header, nowMs)) {
+        qCDebug(cpuMonitor) << "Late fragment of completed sample" << header.sampleId
+                            << "from" << fragment.hostId;
+        return nullptr;
+    }
+
+    if (!assembly.active) {
+        start(assembly, fragment, nowMs);
+    } else if (header.count != assembly.fragmentCount
+               || header.coreCount != assembly.sample.coreUsages.size()) {
+        qCWarning(cpuMonitor) << "Inconsistent fragment header for sample" << header.sampleId
+                              << "from" << fragment.hostId;
+        ++dropped;
+        start(assembly, fragment, nowMs);
+    }
+
+    const quint64 bit = quint64(1) << header.index;
+    if (assembly.receivedMask & bit) {
+        return nullptr; // повтор фрагмента
+    }
+    assembly.receivedMask |= bit;
+
+    CpuSample &sample = assembly.sample;
+    std::copy(fragment.coreUsages.cbegin(), fragment.coreUsages.cend(),
+              sample.coreUsages.begin() + header.coreOffset);
+    if (!fragment.topology.isEmpty()) {
+        // Топология фрагмента — для его диапазона ядер; остальные пока неизвестны
+        if (sample.topology.isEmpty()) {
+            sample.topology.resize(sample.coreUsages.size());
+        }
+        std::copy(fragment.topology.cbegin(), fragment.topology.cend(),
+                  sample.topology.begin() + header.coreOffset);
+    }
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        const QVector<double> &values = fragment.channels.perCore[c];
+        if (values.isEmpty()) {
+            continue;
+        }
+        QVector<double> &assembled = sample.channels.perCore[c];
+        if (assembled.isEmpty()) {
+            assembled.fill(std::numeric_limits<double>::quiet_NaN(), sample.coreUsages.size());
+        }
+        std::copy(values.cbegin(), values.cend(), assembled.begin() + header.coreOffset);
+    }
+    if (fragment.hasSequence) {
+        sample.hasSequence = true;
+        sample.sequence = fragment.sequence;
+    }
+    if (fragment.hasTotal) {
+        sample.hasTotal = true;
+        sample.total = fragment.total;
+    }
+
+    const quint64 fullMask = assembly.fragmentCount == 64
+                                 ? ~quint64(0)
+                                 : (quint64(1) << assembly.fragmentCount) - 1;
+    if (assembly.receivedMask != fullMask) {
+        return nullptr;
+    }
+
+    assembly.active = false;
+    assembly.hasCompleted = true;
+    assembly.completedId = assembly.sampleId;
+    assembly.completedMs = nowMs;
+    ++completed;
+    return &sample;
+}
+
+int FragmentAssembler::expireStale(qint64 nowMs)
+{
+    int expired = 0;
+    for (auto it = assemblies.begin(); it != assemblies.end(); ++it) {
+        Assembly &assembly = it.value();
+        if (assembly.active && nowMs - assembly.startedMs > timeoutMs) {
+            qCDebug(cpuMonitor) << "Fragment reassembly timed out for sample" << assembly.sampleId
+                                << "from" << it.key();
+            assembly.active = false;
+            ++expired;
+        }
+    }
+    dropped += expired;
+    return expired;
+}
@@ -0,0 +1,56 @@
+#ifndef FRAGMENTASSEMBLER_H
+#define FRAGMENTASSEMBLER_H
+
+#include "cpuprotocol.h"
+#include <QHash>
+
+// Собирает сэмплы, разбитые клиентом на несколько датаграмм.
+// Для каждого хоста держится один буфер сборки, который переиспользуется
+// между сэмплами: память выделяется только при росте числа ядер.
+class FragmentAssembler
+{
+public:
+    static constexpr qint64 DEFAULT_TIMEOUT_MS = 1000;
+
+    explicit FragmentAssembler(qint64 timeoutMs = DEFAULT_TIMEOUT_MS);
+
+    // Добавляет фрагмент. Возвращает указатель на собранный сэмпл, когда пришли
+    // все фрагменты, иначе nullptr. Указатель действителен до следующего вызова.
+    const CpuSample *addFragment(const CpuSample &fragment, qint64 nowMs);
+
+    // Отбрасывает незавершенные сборки старше таймаута, возвращает их число
+    int expireStale(qint64 nowMs);
+
+    quint64 completedSamples() const { return completed; }
+    quint64 droppedSamples() const { return dropped; }
+
+private:
+    struct Assembly
+    {
+        bool active = false;
+        quint32 sampleId = 0;
+        // Последний собранный сэмпл: его поздние повторы не начинают новую сборку
+        bool hasCompleted = false;
+        quint32 completedId = 0;
+        qint64 completedMs = 0;
+        int fragmentCount = 0;
+        quint64 receivedMask = 0;  // бит i — фрагмент i получен
+        qint64 startedMs = 0;
+        CpuSample sample;          // буфер с coreUsages на все ядра
+    };
+
+    void start(Assembly &assembly, const CpuSample &fragment, qint64 nowMs);
+
+    bool isLateDuplicate(const Assembly &assembly, const FragmentHeader &header, qint64 nowMs) const;
+
+    // Фрагмент считается опоздавшим повтором, только если его номер не старше этого
+    // числа номеров от последнего собранного сэмпла
+    static constexpr qint32 LATE_SAMPLE_WINDOW = 64;
+
+    qint64 timeoutMs;
+    QHash<QString, Assembly> assemblies;
+    quint64 completed = 0;
+    quint64 dropped = 0;
+};
+
+#endif // FRAGMENTASSEMBLER_H
@@ -0,0 +1,43 @@
+#include "holtforecaster.h"
+#include <cmath>
+
+void HoltForecaster::add(double timeSec, double value)
+{
+    if (std::isnan(value)) {
+        return;
+    }
+    if (samples == 0) {
+        time = timeSec;
+        levelValue = static_cast<float>(value);
+        trendPerSec = 0.0f;
+        samples = 1;
+        return;
+    }
+
+    const double dt = timeSec - time;
+    if (dt <= 0.0) {
+        return;
+    }
+    // Коэффициенты заданы для сэмпла в секунду; при другом интервале
+    // пересчитываются так, чтобы постоянная времени в секундах сохранялась
+    const float alpha = static_cast<float>(1.0 - std::pow(1.0 - ALPHA, dt));
+    const float beta = static_cast<float>(1.0 - std::pow(1.0 - BETA, dt));
+
+    const float predicted = levelValue + trendPerSec * static_cast<float>(dt);
+    const float newLevel = alpha * static_cast<float>(value) + (1.0f - alpha) * predicted;
+    trendPerSec = beta * (newLevel - levelValue) / static_cast<float>(dt) + (1.0f - beta) * trendPerSec;
+    levelValue = newLevel;
+    time = timeSec;
+    if (samples < WARMUP_SAMPLES) {
+        ++samples;
+    }
+}
+
+double HoltForecaster::forecast(double horizonSec) const
+{
+    if (!isReady()) {
+        return std::nan("");
+    }
+    const double value = levelValue + trendPerSec * horizonSec;
+    return value < 0.0 ? 0.0 : (value > 100.0 ? 100.0 : value);
+}
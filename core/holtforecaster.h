@@ -0,0 +1,37 @@
+#ifndef HOLTFORECASTER_H
+#define HOLTFORECASTER_H
+
+#include <QtGlobal>
+
+// Прогноз общей загрузки хоста методом Хольта (уровень + линейный тренд).
+// Тренд хранится в процентах в секунду, поэтому неравномерные интервалы
+// между сэмплами и разрывы учитываются по фактическому времени. Обновление —
+// O(1) на сэмпл, состояние — 24 байта на хост.
+class HoltForecaster
+{
+public:
+    void add(double timeSec, double value);
+
+    // Прогноз на horizonSec секунд после последнего сэмпла, ограниченный 0..100%;
+    // NaN, пока модель не накопила WARMUP_SAMPLES сэмплов
+    double forecast(double horizonSec) const;
+    bool isReady() const { return samples >= WARMUP_SAMPLES; }
+    double lastTime() const { return time; }
+    double level() const { return levelValue; }
+    // Наклон тренда, процентов в минуту
+    double trendPerMinute() const { return trendPerSec * 60.0; }
+
+private:
+    // Сглаживание уровня и тренда на сэмпл при одном сэмпле в секунду:
+    // уровень следует за ~10 с, тренд — за ~1 мин
+    static constexpr float ALPHA = 0.1f;
+    static constexpr float BETA = 0.02f;
+    static constexpr quint16 WARMUP_SAMPLES = 30;
+
+    double time = 0.0;
+    float levelValue = 0.0f;
+    float trendPerSec = 0.0f;
+    quint16 samples = 0;
+};
+
+#endif // HOLTFORECASTER_H
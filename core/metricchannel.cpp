@@ -0,0 +1,45 @@
+#include "metricchannel.h"
+
+namespace {
+
+const char *const NAMES[MetricChannels::COUNT] = {"user", "sys", "iowait", "steal", "irq", "freq"};
+
+} // namespace
+
+QString MetricChannels::name(MetricChannel channel)
+{
+    return NAMES[static_cast<int>(channel)];
+}
+
+bool MetricChannels::fromName(const QString &name, MetricChannel &channel)
+{
+    for (int i = 0; i < COUNT; ++i) {
+        if (name == QLatin1String(NAMES[i])) {
+            channel = static_cast<MetricChannel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+QString MetricChannels::unit(MetricChannel channel)
+{
+    return channel == MetricChannel::Frequency ? "MHz" : "%";
+}
+
+bool ChannelSample::isEmpty() const
+{
+    for (const QVector<double> &values : perCore) {
+        if (!values.isEmpty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChannelSample::clear()
+{
+    for (QVector<double> &values : perCore) {
+        values.clear();
+    }
+}
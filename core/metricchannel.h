@@ -0,0 +1,43 @@
+#ifndef METRICCHANNEL_H
+#define METRICCHANNEL_H
+
+#include <QString>
+#include <QVector>
+
+// Дополнительные каналы по ядрам помимо общей загрузки: разбивка времени CPU
+// (в процентах) и частота (МГц). В протоколе передаются парами key=value после
+// загрузки ядра: «Core 3: 41.5% user=30.2 sys=8.1 iowait=1.0 steal=0 irq=2.2 freq=2400».
+enum class MetricChannel {
+    User,
+    System,
+    IoWait,
+    Steal,
+    Irq,
+    Frequency
+};
+
+namespace MetricChannels
+{
+    constexpr int COUNT = 6;
+    // Каналы разбивки загрузки — первые, частота — последняя
+    constexpr int BREAKDOWN_COUNT = 5;
+
+    // Имя в протоколе: user, sys, iowait, steal, irq, freq
+    QString name(MetricChannel channel);
+    bool fromName(const QString &name, MetricChannel &channel);
+    // «%» для каналов разбивки, «MHz» для частоты
+    QString unit(MetricChannel channel);
+}
+
+// Значения каналов одного сэмпла по ядрам; пустой вектор — канал не передан,
+// поэтому клиенты без расширенного формата не платят ни памятью, ни временем
+struct ChannelSample
+{
+    QVector<double> perCore[MetricChannels::COUNT];
+
+    bool has(MetricChannel channel) const { return !perCore[static_cast<int>(channel)].isEmpty(); }
+    bool isEmpty() const;
+    void clear();
+};
+
+#endif // METRICCHANNEL_H
@@ -0,0 +1,24 @@
+#include "perfcounters.h"
+
+PerfCounters &PerfCounters::global()
+{
+    static PerfCounters counters;
+    return counters;
+}
+
+PerfSnapshot PerfSnapshot::take(const PerfCounters &counters)
+{
+    PerfSnapshot snapshot;
+    snapshot.datagramsReceived = counters.datagramsReceived.load(std::memory_order_relaxed);
+    snapshot.datagramsDropped = counters.datagramsDropped.load(std::memory_order_relaxed);
+    snapshot.samplesAccepted = counters.samplesAccepted.load(std::memory_order_relaxed);
+    snapshot.ingestNsTotal = counters.ingestNsTotal.load(std::memory_order_relaxed);
+    snapshot.ingestCount = counters.ingestCount.load(std::memory_order_relaxed);
+    snapshot.latencyNsTotal = counters.latencyNsTotal.load(std::memory_order_relaxed);
+    snapshot.latencyCount = counters.latencyCount.load(std::memory_order_relaxed);
+    snapshot.replotNsTotal = counters.replotNsTotal.load(std::memory_order_relaxed);
+    snapshot.replotCount = counters.replotCount.load(std::memory_order_relaxed);
+    snapshot.dataLayerReplots = counters.dataLayerReplots.load(std::memory_order_relaxed);
+    snapshot.takenNs = PerfCounters::nowNs();
+    return snapshot;
+}
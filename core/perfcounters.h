@@ -0,0 +1,56 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <chrono>
+
+// Счетчики производительности конвейера. Обновляются на горячих путях
+// атомарными операциями без блокировок; читатель (оверлей, headless-отчет)
+// берет снимок и считает разности между снимками.
+struct PerfCounters
+{
+    std::atomic<quint64> datagramsReceived{0};
+    std::atomic<quint64> datagramsDropped{0};  // неверный размер или ошибка разбора
+    std::atomic<quint64> samplesAccepted{0};
+    std::atomic<quint64> ingestNsTotal{0};     // разбор + сборка + запись в историю
+    std::atomic<quint64> ingestCount{0};
+    std::atomic<quint64> latencyNsTotal{0};    // от приема датаграммы до конца перерисовки
+    std::atomic<quint64> latencyCount{0};
+    std::atomic<quint64> replotNsTotal{0};     // полная перерисовка или только слоя данных
+    std::atomic<quint64> replotCount{0};
+    std::atomic<quint64> dataLayerReplots{0};  // из них без перерисовки осей и сетки
+
+    static PerfCounters &global();
+
+    static void add(std::atomic<quint64> &counter, quint64 value = 1)
+    {
+        counter.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    static qint64 nowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+// Неатомарная копия счетчиков для вычисления разностей
+struct PerfSnapshot
+{
+    quint64 datagramsReceived = 0;
+    quint64 datagramsDropped = 0;
+    quint64 samplesAccepted = 0;
+    quint64 ingestNsTotal = 0;
+    quint64 ingestCount = 0;
+    quint64 latencyNsTotal = 0;
+    quint64 latencyCount = 0;
+    quint64 replotNsTotal = 0;
+    quint64 replotCount = 0;
+    quint64 dataLayerReplots = 0;
+    qint64 takenNs = 0;
+
+    static PerfSnapshot take(const PerfCounters &counters);
+};
+
+#endif // PERFCOUNTERS_H
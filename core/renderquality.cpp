@@ -0,0 +1,60 @@
+#include "renderquality.h"
+
+RenderQuality::RenderQuality(double frameBudgetMs)
+    : budgetMs(frameBudgetMs)
+{
+}
+
+void RenderQuality::setBudget(double ms)
+{
+    budgetMs = ms;
+    overBudgetFrames = 0;
+    underBudgetFrames = 0;
+}
+
+bool RenderQuality::addFrame(double replotMs)
+{
+    average = average < 0.0 ? replotMs : average + SMOOTHING * (replotMs - average);
+
+    if (average > budgetMs) {
+        underBudgetFrames = 0;
+        if (++overBudgetFrames >= DEGRADE_FRAMES && current != Level::Decimated) {
+            changeLevel(static_cast<Level>(static_cast<int>(current) + 1));
+            return true;
+        }
+    } else if (average < budgetMs * RESTORE_HEADROOM) {
+        overBudgetFrames = 0;
+        if (++underBudgetFrames >= RESTORE_FRAMES && current != Level::Full) {
+            changeLevel(static_cast<Level>(static_cast<int>(current) - 1));
+            return true;
+        }
+    } else {
+        overBudgetFrames = 0;
+        underBudgetFrames = 0;
+    }
+    return false;
+}
+
+void RenderQuality::changeLevel(Level level)
+{
+    current = level;
+    // Замеры прежнего уровня к новому не относятся
+    average = -1.0;
+    overBudgetFrames = 0;
+    underBudgetFrames = 0;
+}
+
+QString RenderQuality::levelName(Level level)
+{
+    switch (level) {
+    case Level::Full:
+        return "full";
+    case Level::FastPolylines:
+        return "fast lines";
+    case Level::ThinPens:
+        return "thin pens";
+    case Level::Decimated:
+        return "decimated";
+    }
+    return QString();
+}
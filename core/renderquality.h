@@ -0,0 +1,51 @@
+#ifndef RENDERQUALITY_H
+#define RENDERQUALITY_H
+
+#include <QString>
+
+// Выбирает уровень качества отрисовки по измеренному времени перерисовки.
+// Среднее сглаживается экспоненциально; качество снижается, если среднее
+// несколько кадров подряд выше бюджета, и восстанавливается только после
+// длинной серии кадров с большим запасом — чтобы уровень не «дребезжал».
+// Используется только в обычном режиме QCustomPlot; фоновая отрисовка, лента
+// самописца и сетка спарклайнов уровень не учитывают.
+class RenderQuality
+{
+public:
+    // Каждый уровень включает упрощения предыдущих
+    enum class Level {
+        Full,           // сглаживание, обычные перья
+        FastPolylines,  // без сглаживания графиков, phFastPolylines
+        ThinPens,       // перья толщиной в пиксель
+        Decimated       // прореживание точек до ширины области графика
+    };
+
+    explicit RenderQuality(double frameBudgetMs = 16.0);
+
+    void setBudget(double ms);
+    double budget() const { return budgetMs; }
+
+    // Учесть время очередной перерисовки; true — уровень изменился
+    bool addFrame(double replotMs);
+
+    Level level() const { return current; }
+    double averageMs() const { return average; }
+    static QString levelName(Level level);
+
+private:
+    void changeLevel(Level level);
+
+    static constexpr double SMOOTHING = 0.3;
+    static constexpr int DEGRADE_FRAMES = 3;
+    static constexpr int RESTORE_FRAMES = 30;
+    // Повышать качество, только если среднее ниже этой доли бюджета (запас вдвое)
+    static constexpr double RESTORE_HEADROOM = 0.5;
+
+    double budgetMs;
+    double average = -1.0;  // < 0 — нет замеров на текущем уровне
+    int overBudgetFrames = 0;
+    int underBudgetFrames = 0;
+    Level current = Level::Full;
+};
+
+#endif // RENDERQUALITY_H
@@ -0,0 +1,79 @@
+#include "replaysource.h"
+#include "cpumonitorlog.h"
+#include <QTimer>
+#include <cmath>
+
+ReplaySource::ReplaySource(QObject *parent)
+    : QObject(parent)
+    , timer(new QTimer(this))
+{
+    timer->setSingleShot(true);
+    connect(timer, &QTimer::timeout, this, &ReplaySource::onTimer);
+}
+
+bool ReplaySource::open(const QString &path, QString *errorString)
+{
+    if (!reader.open(path, errorString)) {
+        return false;
+    }
+    hasNext = reader.readNext(next);
+    firstCaptureMs = next.receiveTimeMs;
+    return true;
+}
+
+void ReplaySource::start(double replaySpeed)
+{
+    speed = replaySpeed;
+    emitted = 0;
+    active = true;
+    clock.start();
+    timer->start(0);
+}
+
+void ReplaySource::onTimer()
+{
+    if (speed <= 0.0) {
+        // Максимальная скорость: пачка записей, затем возврат в цикл событий
+        for (int i = 0; i < MAX_SPEED_BATCH && hasNext; ++i) {
+            emit datagramReady(next.data, next.sender, next.receiveTimeMs);
+            ++emitted;
+            hasNext = reader.readNext(next);
+        }
+        if (!hasNext) {
+            finish();
+            return;
+        }
+        timer->start(0);
+        return;
+    }
+
+    // Выдаем все записи, чье время уже наступило по ускоренным часам
+    const double replayedMs = clock.elapsed() * speed;
+    while (hasNext && next.receiveTimeMs - firstCaptureMs <= replayedMs) {
+        emit datagramReady(next.data, next.sender, next.receiveTimeMs);
+        ++emitted;
+        hasNext = reader.readNext(next);
+    }
+
+    if (!hasNext) {
+        finish();
+        return;
+    }
+
+    const double waitMs = (next.receiveTimeMs - firstCaptureMs - replayedMs) / speed;
+    timer->start(qMax(0, static_cast<int>(std::ceil(waitMs))));
+}
+
+void ReplaySource::finish()
+{
+    active = false;
+    if (reader.hasError()) {
+        qCWarning(cpuMonitor) << "Replay stopped on a damaged capture:" << reader.errorString();
+    }
+    reader.close();
+
+    const qint64 elapsedMs = clock.elapsed();
+    qCInfo(cpuMonitor) << "Replay finished:" << emitted << "datagrams in" << elapsedMs << "ms"
+                       << "(" << (elapsedMs > 0 ? emitted * 1000.0 / elapsedMs : 0.0) << "datagrams/s )";
+    emit finished(emitted, elapsedMs);
+}
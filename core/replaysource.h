@@ -0,0 +1,49 @@
+#ifndef REPLAYSOURCE_H
+#define REPLAYSOURCE_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include "capturefile.h"
+
+class QTimer;
+
+// Воспроизводит файл записи, выдавая датаграммы в тот же конвейер,
+// что и UDP-сокет. Скорость: 1 — реальное время, N — ускорение в N раз,
+// 0 — максимально быстро (используется как бенчмарк всего конвейера).
+class ReplaySource : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ReplaySource(QObject *parent = nullptr);
+
+    bool open(const QString &path, QString *errorString = nullptr);
+    void start(double speed);
+    bool isActive() const { return active; }
+
+signals:
+    void datagramReady(const QByteArray &data, const QString &sender, qint64 receiveTimeMs);
+    void finished(quint64 datagrams, qint64 elapsedMs);
+
+private slots:
+    void onTimer();
+
+private:
+    void finish();
+
+    // Сколько записей выдавать за один проход в режиме максимальной скорости,
+    // чтобы цикл событий продолжал обрабатывать ввод
+    static constexpr int MAX_SPEED_BATCH = 256;
+
+    CaptureReader reader;
+    QTimer *timer;
+    QElapsedTimer clock;
+    CaptureRecord next;
+    bool hasNext = false;
+    bool active = false;
+    double speed = 1.0;
+    qint64 firstCaptureMs = 0;
+    quint64 emitted = 0;
+};
+
+#endif // REPLAYSOURCE_H
@@ -0,0 +1,78 @@
+#include "sequencetracker.h"
+
+void SequenceTracker::reset()
+{
+    started = false;
+    highest = 0;
+    window = 0;
+    lastGap = 0;
+}
+
+SequenceTracker::Result SequenceTracker::update(quint32 sequence)
+{
+    lastGap = 0;
+
+    if (!started) {
+        started = true;
+        highest = sequence;
+        window = 1;
+        ++counters.received;
+        return Result::InOrder;
+    }
+
+    // Разность по модулю 2^32 — переполнение счетчика клиента не считается скачком
+    const qint64 delta = static_cast<qint32>(sequence - highest);
+
+    if (delta > 0) {
+        if (delta > MAX_FORWARD_JUMP) {
+            reset();
+            update(sequence);
+            return Result::Restarted;
+        }
+
+        window = delta >= WINDOW_SIZE ? 0 : window << delta;
+        window |= 1;
+        highest = sequence;
+        ++counters.received;
+
+        if (delta == 1) {
+            return Result::InOrder;
+        }
+        lastGap = static_cast<quint32>(delta - 1);
+        counters.lost += lastGap;
+        return Result::Gap;
+    }
+
+    const qint64 age = -delta;
+    if (age >= WINDOW_SIZE) {
+        // Слишком старый номер: скорее всего клиент начал счет заново
+        if (age > MAX_FORWARD_JUMP) {
+            reset();
+            update(sequence);
+            return Result::Restarted;
+        }
+        // Вне окна дубликат неотличим от опоздавшего — считаем опоздавшим
+        acceptLate();
+        return Result::Reordered;
+    }
+
+    const quint64 bit = quint64(1) << age;
+    if (window & bit) {
+        ++counters.duplicated;
+        return Result::Duplicate;
+    }
+
+    window |= bit;
+    acceptLate();
+    return Result::Reordered;
+}
+
+void SequenceTracker::acceptLate()
+{
+    // Номер был засчитан как потерянный — переносим его в опоздавшие
+    ++counters.received;
+    if (counters.lost > 0) {
+        --counters.lost;
+    }
+    ++counters.reordered;
+}
@@ -0,0 +1,65 @@
+#ifndef SEQUENCETRACKER_H
+#define SEQUENCETRACKER_H
+
+#include <QtGlobal>
+
+// Счетчики доставки датаграмм одного хоста
+struct SequenceStats
+{
+    quint64 received = 0;   // принято уникальных датаграмм
+    quint64 lost = 0;       // пропущено номеров (с учетом опоздавших)
+    quint64 duplicated = 0; // повторно принятые номера
+    quint64 reordered = 0;  // пришли позже более новых
+
+    double lossRatio() const
+    {
+        const quint64 expected = received + lost;
+        return expected ? static_cast<double>(lost) / expected : 0.0;
+    }
+
+    SequenceStats &operator+=(const SequenceStats &other)
+    {
+        received += other.received;
+        lost += other.lost;
+        duplicated += other.duplicated;
+        reordered += other.reordered;
+        return *this;
+    }
+};
+
+// Отслеживает порядковые номера датаграмм одного хоста.
+// Недавно принятые номера хранятся в 64-битном окне (как anti-replay окно IPsec),
+// поэтому дубликаты и опоздавшие пакеты различаются за O(1) без хранения истории.
+class SequenceTracker
+{
+public:
+    enum class Result {
+        InOrder,    // следующий ожидаемый номер
+        Gap,        // номер больше ожидаемого, между ними потери
+        Reordered,  // номер из окна, ранее учтенный как потерянный
+        Duplicate,  // номер уже был принят
+        Restarted   // клиент перезапустился или скачок слишком велик
+    };
+
+    Result update(quint32 sequence);
+
+    // Количество номеров, пропущенных при последнем Result::Gap
+    quint32 lastGapSize() const { return lastGap; }
+    const SequenceStats &stats() const { return counters; }
+    void reset();
+
+private:
+    void acceptLate();
+
+    static constexpr int WINDOW_SIZE = 64;
+    // Скачок больше этого значения считаем перезапуском клиента, а не потерей
+    static constexpr qint64 MAX_FORWARD_JUMP = 1 << 16;
+
+    bool started = false;
+    quint32 highest = 0;  // наибольший принятый номер
+    quint64 window = 0;   // бит i — принят номер (highest - i)
+    quint32 lastGap = 0;
+    SequenceStats counters;
+};
+
+#endif // SEQUENCETRACKER_H
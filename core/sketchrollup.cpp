@@ -0,0 +1,150 @@
+#include "sketchrollup.h"
+#include <cmath>
+
+namespace {
+
+constexpr double MINUTE_SEC = 60.0;
+constexpr double HOUR_SEC = 3600.0;
+constexpr int MINUTE_SLOTS = 60;  // последний час
+constexpr int HOUR_SLOTS = 24;    // последние сутки
+
+} // namespace
+
+double SketchRollup::windowSeconds(Tier tier)
+{
+    return tier == Tier::Minute ? MINUTE_SEC : HOUR_SEC;
+}
+
+int SketchRollup::slotCount(Tier tier)
+{
+    return tier == Tier::Minute ? MINUTE_SLOTS : HOUR_SLOTS;
+}
+
+qint64 SketchRollup::memoryBytes() const
+{
+    qint64 windows = 0;
+    for (const Series &s : series) {
+        windows += s.minutes.windows.size() + s.hours.windows.size();
+    }
+    return static_cast<qint64>(series.size()) * sizeof(Series) + windows * static_cast<qint64>(sizeof(Window));
+}
+
+const SketchRollup::Window *SketchRollup::findWindow(const Ring &ring, int slots, qint64 index)
+{
+    if (ring.first < 0 || index < ring.first) {
+        return nullptr;
+    }
+    const int slot = static_cast<int>((index - ring.first) % slots);
+    if (slot >= ring.windows.size() || ring.windows[slot].index != index) {
+        return nullptr;
+    }
+    return &ring.windows[slot];
+}
+
+const SketchRollup::Ring &SketchRollup::ring(const Series &s, Tier tier)
+{
+    return tier == Tier::Minute ? s.minutes : s.hours;
+}
+
+void SketchRollup::add(double timeSec, double total, const QVector<double> &coreUsages)
+{
+    // Ряды создаются по мере появления ядер, окна — по мере наступления
+    const int needed = 1 + qMin(coreUsages.size(), maxCores);
+    if (series.size() < needed) {
+        series.resize(needed);
+    }
+
+    for (int i = 0; i < needed; ++i) {
+        const double value = i == 0 ? total : coreUsages[i - 1];
+        if (std::isnan(value)) {
+            continue;
+        }
+        Series &s = series[i];
+        addToRing(s.minutes, MINUTE_SEC, MINUTE_SLOTS, timeSec, value);
+        addToRing(s.hours, HOUR_SEC, HOUR_SLOTS, timeSec, value);
+    }
+}
+
+void SketchRollup::addToRing(Ring &ring, double windowSec, int slots, double timeSec, double value)
+{
+    const qint64 index = static_cast<qint64>(std::floor(timeSec / windowSec));
+    if (ring.first < 0) {
+        ring.first = ring.newest = index;
+    }
+    // Опоздавший сэмпл старше кольца или первого окна
+    if (index < ring.first || index <= ring.newest - slots) {
+        return;
+    }
+
+    const int slot = static_cast<int>((index - ring.first) % slots);
+    if (slot >= ring.windows.size()) {
+        ring.windows.resize(slot + 1);
+    }
+    Window &window = ring.windows[slot];
+    if (window.index != index) {
+        window.index = index;
+        window.sketch.clear();
+    }
+    window.sketch.add(value);
+    ring.newest = qMax(ring.newest, index);
+}
+
+UsageSketch SketchRollup::query(int seriesIndex, double fromSec, double toSec) const
+{
+    UsageSketch result;
+    if (seriesIndex < 0 || seriesIndex >= series.size()) {
+        return result;
+    }
+    const Series &s = series[seriesIndex];
+
+    // Граница уровней выровнена по часу, чтобы часовое окно не пересекалось
+    // с минутными: до нее берутся часовые окна, после — минутные
+    double boundary = toSec;
+    if (s.minutes.newest >= 0) {
+        const double oldestMinute = (s.minutes.newest - MINUTE_SLOTS + 1) * MINUTE_SEC;
+        boundary = std::ceil(oldestMinute / HOUR_SEC) * HOUR_SEC;
+    }
+
+    for (const Window &window : s.minutes.windows) {
+        const double start = window.index * MINUTE_SEC;
+        if (window.index >= 0 && start >= boundary && start >= fromSec && start < toSec) {
+            result.merge(window.sketch);
+        }
+    }
+    for (const Window &window : s.hours.windows) {
+        const double start = window.index * HOUR_SEC;
+        if (window.index >= 0 && start + HOUR_SEC <= boundary && start + HOUR_SEC > fromSec && start < toSec) {
+            result.merge(window.sketch);
+        }
+    }
+    return result;
+}
+
+void SketchRollup::copyQuantiles(int seriesIndex, Tier tier, QVector<double> &times, QVector<double> &p50,
+                                 QVector<double> &p95, QVector<double> &p99) const
+{
+    times.clear();
+    p50.clear();
+    p95.clear();
+    p99.clear();
+    if (seriesIndex < 0 || seriesIndex >= series.size()) {
+        return;
+    }
+
+    const Ring &r = ring(series[seriesIndex], tier);
+    if (r.newest < 0) {
+        return;
+    }
+    const double windowSec = windowSeconds(tier);
+    const int slots = slotCount(tier);
+    for (qint64 index = qMax(r.first, r.newest - slots + 1); index <= r.newest; ++index) {
+        const Window *window = findWindow(r, slots, index);
+        if (!window || window->sketch.isEmpty()) {
+            continue;
+        }
+        times.append((index + 0.5) * windowSec);
+        p50.append(window->sketch.quantile(0.50));
+        p95.append(window->sketch.quantile(0.95));
+        p99.append(window->sketch.quantile(0.99));
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef SKETCHROLLUP_H
+#define SKETCHROLLUP_H
+
+#include "usagesketch.h"
+#include <QVector>
+
+// Квантильные эскизы загрузки хоста по окнам свертки. Ряд 0 — общая загрузка,
+// ряд i + 1 — ядро i. Для каждого ряда два уровня колец: минутные окна за
+// последний час и часовые за последние сутки. Сэмпл обновляет по одному
+// эскизу на уровень, а запрос за любой интервал сливает готовые эскизы,
+// не просматривая сырые данные. Окна выделяются по мере наступления, так что
+// память растет до предела (84 эскиза на ряд) только за сутки приема.
+// Ряды ядер ведутся только для первых coreLimit() ядер: эскиз окна ~440 байт,
+// и бюджет рядов по всему парку задает владелец.
+class SketchRollup
+{
+public:
+    enum class Tier {
+        Minute,
+        Hour
+    };
+
+    void add(double timeSec, double total, const QVector<double> &coreUsages);
+
+    // Сколько первых ядер получают свои ряды; 0 — только общая загрузка
+    void setCoreLimit(int cores) { maxCores = qMax(0, cores); }
+    int coreLimit() const { return maxCores; }
+    bool tracksCores() const { return maxCores > 0; }
+    int seriesCount() const { return series.size(); }
+    bool isEmpty() const { return series.isEmpty(); }
+
+    // Эскиз ряда за [fromSec, toSec): минутные окна там, где они еще хранятся,
+    // часовые — для более старой части
+    UsageSketch query(int seriesIndex, double fromSec, double toSec) const;
+
+    // Квантили по окнам уровня от старых к новым; время — середина окна
+    void copyQuantiles(int seriesIndex, Tier tier, QVector<double> &times, QVector<double> &p50,
+                       QVector<double> &p95, QVector<double> &p99) const;
+
+    static double windowSeconds(Tier tier);
+    // Память выделенных окон в байтах
+    qint64 memoryBytes() const;
+
+private:
+    struct Window
+    {
+        qint64 index = -1;
+        UsageSketch sketch;
+    };
+    // Окно index лежит в слоте (index - first) % slots; слоты добавляются
+    // по одному по мере наступления новых окон
+    struct Ring
+    {
+        QVector<Window> windows;
+        qint64 first = -1;
+        qint64 newest = -1;
+    };
+    struct Series
+    {
+        Ring minutes;
+        Ring hours;
+    };
+
+    static void addToRing(Ring &ring, double windowSec, int slots, double timeSec, double value);
+    static const Window *findWindow(const Ring &ring, int slots, qint64 index);
+    static const Ring &ring(const Series &s, Tier tier);
+    static int slotCount(Tier tier);
+
+    int maxCores = 0;
+    QVector<Series> series;
+};
+
+#endif // SKETCHROLLUP_H
@@ -0,0 +1,127 @@
+#include "topologymap.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// Неизвестные значения сортируются в конец
+constexpr int UNKNOWN_KEY = std::numeric_limits<int>::max();
+
+int sortKey(int id)
+{
+    return id < 0 ? UNKNOWN_KEY : id;
+}
+
+} // namespace
+
+bool TopologyMap::update(const QVector<CoreTopology> &topology)
+{
+    if (topology == cores) {
+        return false;
+    }
+    cores = topology;
+    rebuild();
+    ++rev;
+    return true;
+}
+
+void TopologyMap::rebuild()
+{
+    const int n = cores.size();
+    for (LevelIndex &index : levels) {
+        index = LevelIndex();
+        index.groupOfCore.resize(n);
+    }
+
+    QVector<int> order(n);
+    for (int i = 0; i < n; ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](int a, int b) {
+        const CoreTopology &x = cores[a];
+        const CoreTopology &y = cores[b];
+        if (sortKey(x.socket) != sortKey(y.socket)) {
+            return sortKey(x.socket) < sortKey(y.socket);
+        }
+        if (sortKey(x.node) != sortKey(y.node)) {
+            return sortKey(x.node) < sortKey(y.node);
+        }
+        return sortKey(x.physicalCore) < sortKey(y.physicalCore);
+    });
+
+    LevelIndex &sockets = levels[static_cast<int>(Level::Socket)];
+    LevelIndex &nodes = levels[static_cast<int>(Level::Node)];
+    LevelIndex &physical = levels[static_cast<int>(Level::PhysicalCore)];
+    auto addGroup = [](LevelIndex &index, int id, int parent) {
+        index.ids.append(id);
+        index.parent.append(parent);
+        index.members.append(QVector<int>());
+    };
+
+    // Проход по отсортированным ядрам: новая группа начинается там, где меняется ключ,
+    // поэтому группы сразу упорядочены и вложены
+    const CoreTopology *previous = nullptr;
+    for (int core : order) {
+        const CoreTopology &topology = cores[core];
+        const bool newSocket = !previous || previous->socket != topology.socket;
+        const bool newNode = newSocket || previous->node != topology.node;
+        // У ядра без номера физического ядра SMT-соседей нет
+        const bool newPhysical = newNode || previous->physicalCore != topology.physicalCore
+                                 || topology.physicalCore < 0;
+        if (newSocket) {
+            addGroup(sockets, topology.socket, -1);
+        }
+        if (newNode) {
+            addGroup(nodes, topology.node, sockets.ids.size() - 1);
+        }
+        if (newPhysical) {
+            addGroup(physical, topology.physicalCore, nodes.ids.size() - 1);
+        }
+        for (LevelIndex &index : levels) {
+            index.groupOfCore[core] = index.members.size() - 1;
+            index.members.last().append(core);
+        }
+        previous = &topology;
+    }
+}
+
+QString TopologyMap::groupName(Level level, int group) const
+{
+    const int id = levels[static_cast<int>(level)].ids[group];
+    const QString number = id < 0 ? QString("?") : QString::number(id);
+    switch (level) {
+    case Level::Socket:
+        return QString("Socket %1").arg(number);
+    case Level::Node:
+        return QString("Node %1").arg(number);
+    case Level::PhysicalCore:
+        break;
+    }
+    return QString("Physical core %1").arg(number);
+}
+
+void TopologyMap::aggregate(Level level, const QVector<double> &coreUsages,
+                            QVector<double> &out, QVector<int> &counts) const
+{
+    const LevelIndex &index = levels[static_cast<int>(level)];
+    const int groups = index.members.size();
+    out.fill(0.0, groups);
+    counts.fill(0, groups);
+
+    const int n = qMin(coreUsages.size(), cores.size());
+    const double *usages = coreUsages.constData();
+    const int *groupOfCore = index.groupOfCore.constData();
+    double *sums = out.data();
+    int *online = counts.data();
+    for (int i = 0; i < n; ++i) {
+        const double value = usages[i];
+        const bool on = value == value;  // NaN — ядро offline
+        sums[groupOfCore[i]] += on ? value : 0.0;
+        online[groupOfCore[i]] += on;
+    }
+
+    for (int g = 0; g < groups; ++g) {
+        sums[g] = online[g] > 0 ? sums[g] / online[g] : std::nan("");
+    }
+}
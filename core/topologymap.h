@@ -0,0 +1,62 @@
+#ifndef TOPOLOGYMAP_H
+#define TOPOLOGYMAP_H
+
+#include "cpuprotocol.h"
+#include <QString>
+#include <QVector>
+
+// Группировка логических ядер хоста по топологии: физическое ядро (SMT-соседи),
+// NUMA-узел, сокет. Индексы «ядро → группа» строятся один раз при смене карты,
+// поэтому агрегация сэмпла — один проход по массиву ядер без поиска.
+// Группы каждого уровня упорядочены по (сокет, узел, ядро); группа вложена
+// ровно в одну группу уровня выше. Ядра с неизвестным сокетом попадают
+// в отдельный сокет «?», с неизвестным физическим ядром — каждое в свою группу.
+class TopologyMap
+{
+public:
+    enum class Level {
+        PhysicalCore,
+        Node,
+        Socket
+    };
+    static constexpr int LEVEL_COUNT = 3;
+
+    // Перестраивает индексы, если карта изменилась; возвращает true при изменении
+    bool update(const QVector<CoreTopology> &topology);
+
+    bool isEmpty() const { return cores.isEmpty(); }
+    // Число ядер в карте; ядра сэмпла с большими номерами в агрегаты не входят
+    int coreCount() const { return cores.size(); }
+    const CoreTopology &core(int index) const { return cores[index]; }
+    // Растет при каждой смене карты: по нему виджеты узнают, что пора перестроиться
+    quint32 revision() const { return rev; }
+
+    int groupCount(Level level) const { return levels[static_cast<int>(level)].members.size(); }
+    int groupOf(Level level, int core) const { return levels[static_cast<int>(level)].groupOfCore[core]; }
+    // Группа уровня выше (для сокета — -1)
+    int parentOf(Level level, int group) const { return levels[static_cast<int>(level)].parent[group]; }
+    const QVector<int> &members(Level level, int group) const { return levels[static_cast<int>(level)].members[group]; }
+    QString groupName(Level level, int group) const;
+
+    // Средняя загрузка ядер online каждой группы уровня level (NaN — в группе нет
+    // ядер online). counts — буфер, переиспользуемый между вызовами.
+    void aggregate(Level level, const QVector<double> &coreUsages,
+                   QVector<double> &out, QVector<int> &counts) const;
+
+private:
+    struct LevelIndex
+    {
+        QVector<int> groupOfCore;
+        QVector<int> parent;
+        QVector<QVector<int>> members;
+        QVector<int> ids;  // номер сокета, узла или физического ядра группы
+    };
+
+    void rebuild();
+
+    QVector<CoreTopology> cores;
+    LevelIndex levels[LEVEL_COUNT];
+    quint32 rev = 0;
+};
+
+#endif // TOPOLOGYMAP_H
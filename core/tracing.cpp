@@ -0,0 +1,219 @@
+#include "tracing.h"
+#include "cpumonitorlog.h"
+#include <QFile>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSocketNotifier>
+#include <QVector>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#ifdef Q_OS_UNIX
+#include <csignal>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+std::atomic<bool> Tracing::enabledFlag{false};
+
+namespace {
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 startNs;
+    qint64 endNs;
+};
+
+// Ячейка кольцевого буфера. Поля атомарные, а sequence — номер записанного события + 1
+// (0 — ячейка переписывается): выгрузка читает поля между двумя чтениями sequence
+// и отбрасывает ячейку, если владелец успел ее переписать
+struct TraceSlot
+{
+    std::atomic<quint64> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> startNs{0};
+    std::atomic<qint64> endNs{0};
+};
+
+// Кольцевой буфер одного потока. Пишет только владелец; выгрузка идет параллельно
+// с записью и пропускает события, переписанные во время чтения.
+struct ThreadBuffer
+{
+    static constexpr int CAPACITY = 1 << 16;
+
+    explicit ThreadBuffer(int threadId)
+        : threadId(threadId)
+        , events(CAPACITY)
+    {
+    }
+
+    int threadId;
+    std::vector<TraceSlot> events;
+    std::atomic<quint64> written{0};
+};
+
+QMutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> registry;
+
+ThreadBuffer *currentBuffer()
+{
+    // Буферы не удаляются до выхода из программы, чтобы выгрузка
+    // видела события завершившихся потоков
+    thread_local ThreadBuffer *buffer = nullptr;
+    if (!buffer) {
+        QMutexLocker locker(&registryMutex);
+        registry.push_back(std::make_unique<ThreadBuffer>(static_cast<int>(registry.size()) + 1));
+        buffer = registry.back().get();
+    }
+    return buffer;
+}
+
+// Копия события i, если ячейка не переписана владельцем во время чтения
+bool readEvent(const ThreadBuffer &buffer, quint64 i, TraceEvent &event)
+{
+    const TraceSlot &slot = buffer.events[i % ThreadBuffer::CAPACITY];
+    if (slot.sequence.load(std::memory_order_acquire) != i + 1) {
+        return false;
+    }
+    event.name = slot.name.load(std::memory_order_relaxed);
+    event.startNs = slot.startNs.load(std::memory_order_relaxed);
+    event.endNs = slot.endNs.load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot.sequence.load(std::memory_order_relaxed) == i + 1;
+}
+
+void writeJsonString(QByteArray &out, const char *text)
+{
+    out += '"';
+    for (const char *c = text; *c; ++c) {
+        if (*c == '"' || *c == '\\') {
+            out += '\\';
+        }
+        out += *c;
+    }
+    out += '"';
+}
+
+#ifdef Q_OS_UNIX
+int signalPipe[2] = {-1, -1};
+
+void dumpSignalHandler(int)
+{
+    // В обработчике сигнала допустим только async-signal-safe write()
+    char byte = 1;
+    ssize_t written = ::write(signalPipe[0], &byte, 1);
+    Q_UNUSED(written);
+}
+#endif
+
+} // namespace
+
+void Tracing::setEnabled(bool enabled)
+{
+    enabledFlag.store(enabled, std::memory_order_relaxed);
+    qCInfo(cpuMonitor) << "Tracing" << (enabled ? "enabled" : "disabled");
+}
+
+qint64 Tracing::nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Tracing::record(const char *name, qint64 startNs, qint64 endNs)
+{
+    ThreadBuffer *buffer = currentBuffer();
+    const quint64 index = buffer->written.load(std::memory_order_relaxed);
+    TraceSlot &slot = buffer->events[index % ThreadBuffer::CAPACITY];
+    slot.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.startNs.store(startNs, std::memory_order_relaxed);
+    slot.endNs.store(endNs, std::memory_order_relaxed);
+    slot.sequence.store(index + 1, std::memory_order_release);
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+int Tracing::writeChromeTrace(const QString &path, QString *errorString)
+{
+    QByteArray json;
+    json.reserve(1 << 20);
+    json += "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    int count = 0;
+    int skipped = 0;
+    {
+        QMutexLocker locker(&registryMutex);
+        for (const auto &buffer : registry) {
+            const quint64 written = buffer->written.load(std::memory_order_acquire);
+            const quint64 first = written > ThreadBuffer::CAPACITY ? written - ThreadBuffer::CAPACITY : 0;
+            for (quint64 i = first; i < written; ++i) {
+                TraceEvent event;
+                if (!readEvent(*buffer, i, event)) {
+                    ++skipped;
+                    continue;
+                }
+                if (count++ > 0) {
+                    json += ',';
+                }
+                // Формат Complete event: ts и dur в микросекундах
+                json += "{\"ph\":\"X\",\"pid\":1,\"tid\":";
+                json += QByteArray::number(buffer->threadId);
+                json += ",\"name\":";
+                writeJsonString(json, event.name);
+                json += ",\"ts\":";
+                json += QByteArray::number(event.startNs / 1000.0, 'f', 3);
+                json += ",\"dur\":";
+                json += QByteArray::number((event.endNs - event.startNs) / 1000.0, 'f', 3);
+                json += '}';
+            }
+        }
+    }
+    json += "]}\n";
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return -1;
+    }
+
+    qCInfo(cpuMonitor) << "Wrote" << count << "trace events to" << path;
+    if (skipped > 0) {
+        qCDebug(cpuMonitor) << skipped << "trace events were overwritten during the dump";
+    }
+    return count;
+}
+
+void Tracing::installDumpSignalHandler(const QString &path)
+{
+#ifdef Q_OS_UNIX
+    if (signalPipe[0] != -1) {
+        return;
+    }
+    if (::socketpair(AF_UNIX, SOCK_STREAM, 0, signalPipe) != 0) {
+        qCWarning(cpuMonitor) << "Failed to create trace signal socket pair";
+        return;
+    }
+
+    // Сигнал будит цикл событий через сокет, выгрузка выполняется уже в основном потоке
+    QSocketNotifier *notifier = new QSocketNotifier(signalPipe[1], QSocketNotifier::Read);
+    QObject::connect(notifier, &QSocketNotifier::activated, notifier, [path]() {
+        char byte;
+        if (::read(signalPipe[1], &byte, 1) == 1) {
+            writeChromeTrace(path);
+        }
+    });
+
+    struct sigaction action = {};
+    action.sa_handler = dumpSignalHandler;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    sigaction(SIGUSR1, &action, nullptr);
+#else
+    Q_UNUSED(path);
+#endif
+}
@@ -0,0 +1,65 @@
+#ifndef TRACING_H
+#define TRACING_H
+
+#include <QString>
+#include <atomic>
+
+// Низконакладная трассировка горячих путей.
+// Интервалы пишутся в кольцевой буфер своего потока без блокировок
+// и выгружаются в формате Chrome trace events (chrome://tracing, Perfetto).
+// Пока трассировка выключена, TRACE_SCOPE стоит одно чтение флага и две проверки
+// указателя — в конструкторе и деструкторе интервала.
+namespace Tracing
+{
+    extern std::atomic<bool> enabledFlag;
+
+    inline bool isEnabled() { return enabledFlag.load(std::memory_order_relaxed); }
+    void setEnabled(bool enabled);
+
+    // Монотонное время в наносекундах
+    qint64 nowNs();
+    // Запись завершенного интервала в буфер текущего потока
+    void record(const char *name, qint64 startNs, qint64 endNs);
+
+    // Выгрузка всех буферов в JSON; возвращает число событий или -1 при ошибке
+    int writeChromeTrace(const QString &path, QString *errorString = nullptr);
+
+    // Unix: выгрузка по SIGUSR1 в указанный файл. Требует запущенного цикла событий.
+    void installDumpSignalHandler(const QString &path);
+}
+
+// Интервал от конструктора до деструктора. name должен жить все время работы
+// программы (строковый литерал).
+// Флаг читается один раз: выключенная трассировка оставляет name пустым,
+// и деструктор проверяет только это решение конструктора, так что интервал,
+// начатый до переключения флага, записывается или пропускается целиком.
+class TraceSpan
+{
+public:
+    explicit TraceSpan(const char *name)
+        : name(Tracing::isEnabled() ? name : nullptr)
+    {
+        if (this->name) {
+            startNs = Tracing::nowNs();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (name) {
+            Tracing::record(name, startNs, Tracing::nowNs());
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(TraceSpan)
+
+    const char *name;
+    qint64 startNs = 0;
+};
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(name) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(name)
+
+#endif // TRACING_H
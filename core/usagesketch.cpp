@@ -0,0 +1,67 @@
+#include "usagesketch.h"
+#include <algorithm>
+#include <cmath>
+
+void UsageSketch::add(double value)
+{
+    if (std::isnan(value)) {
+        return;
+    }
+    value = qBound(0.0, value, 100.0);
+
+    const int bin = qMin(BINS - 1, static_cast<int>(value * BINS / 100.0));
+    ++bins[bin];
+    minValue = total ? qMin(minValue, value) : value;
+    maxValue = total ? qMax(maxValue, value) : value;
+    sum += value;
+    ++total;
+}
+
+void UsageSketch::merge(const UsageSketch &other)
+{
+    if (other.total == 0) {
+        return;
+    }
+    for (int i = 0; i < BINS; ++i) {
+        bins[i] += other.bins[i];
+    }
+    minValue = total ? qMin(minValue, other.minValue) : other.minValue;
+    maxValue = total ? qMax(maxValue, other.maxValue) : other.maxValue;
+    sum += other.sum;
+    total += other.total;
+}
+
+void UsageSketch::clear()
+{
+    std::fill(bins, bins + BINS, 0u);
+    total = 0;
+    sum = 0.0;
+    minValue = 0.0;
+    maxValue = 0.0;
+}
+
+double UsageSketch::quantile(double q) const
+{
+    if (total == 0) {
+        return std::nan("");
+    }
+    q = qBound(0.0, q, 1.0);
+
+    // Ранг искомого значения среди total значений, как при сортировке
+    const double rank = q * (total - 1);
+    quint64 below = 0;
+    for (int i = 0; i < BINS; ++i) {
+        if (bins[i] == 0) {
+            continue;
+        }
+        if (rank < below + bins[i]) {
+            // Значения корзины считаем равномерно распределенными по ее ширине
+            const double binWidth = 100.0 / BINS;
+            const double fraction = (rank - below + 0.5) / bins[i];
+            const double value = (i + fraction) * binWidth;
+            return qBound(minValue, value, maxValue);
+        }
+        below += bins[i];
+    }
+    return maxValue;
+}
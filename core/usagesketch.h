@@ -0,0 +1,35 @@
+#ifndef USAGESKETCH_H
+#define USAGESKETCH_H
+
+#include <QtGlobal>
+
+// Сливаемый эскиз распределения загрузки 0..100%: гистограмма с фиксированными
+// корзинами шириной 1% плюс точные минимум, максимум и сумма. Память постоянна,
+// сложение и слияние — O(1) и O(BINS), квантиль — O(BINS) с точностью до
+// ширины корзины (внутри корзины значение интерполируется линейно).
+class UsageSketch
+{
+public:
+    static constexpr int BINS = 100;
+
+    void add(double value);
+    void merge(const UsageSketch &other);
+    void clear();
+
+    quint32 count() const { return total; }
+    bool isEmpty() const { return total == 0; }
+    double mean() const { return total ? sum / total : 0.0; }
+    double min() const { return minValue; }
+    double max() const { return maxValue; }
+    // q в [0, 1]; для пустого эскиза — NaN
+    double quantile(double q) const;
+
+private:
+    quint32 bins[BINS] = {};
+    quint32 total = 0;
+    double sum = 0.0;
+    double minValue = 0.0;
+    double maxValue = 0.0;
+};
+
+#endif // USAGESKETCH_H
@@ -0,0 +1,168 @@
+#include "fleetview.h"
+#include <QBrush>
+#include <QColor>
+#include <QHash>
+#include <QPainter>
+#include <QPolygonF>
+
+FleetModel::FleetModel(const FleetRanking &ranking, QObject *parent)
+    : QAbstractTableModel(parent)
+    , ranking(ranking)
+{
+}
+
+void FleetModel::setKey(FleetRanking::Key key)
+{
+    if (rankKey != key) {
+        rankKey = key;
+        refresh(refreshedAtMs);
+    }
+}
+
+void FleetModel::refresh(qint64 nowMs)
+{
+    refreshedAtMs = nowMs;
+    const int oldCount = rows.size();
+    const int newCount = ranking.hostCount();
+
+    // Хосты только добавляются: новые строки сначала вставляются в конец,
+    // а затем вместе с остальными встают на свои места при смене порядка
+    if (newCount > oldCount) {
+        beginInsertRows(QModelIndex(), oldCount, newCount - 1);
+        rows.resize(newCount);
+        endInsertRows();
+    }
+
+    // Смена порядка — layoutChanged: постоянные индексы (выделение, текущая строка)
+    // переносятся на строку того же хоста
+    emit layoutAboutToBeChanged();
+    const QModelIndexList persistent = persistentIndexList();
+    QVector<QString> persistentIds;
+    persistentIds.reserve(persistent.size());
+    for (const QModelIndex &index : persistent) {
+        persistentIds.append(rows[index.row()].id);
+    }
+
+    ranking.ranked(rankKey, order);
+    QHash<QString, int> rowById;
+    rowById.reserve(order.size());
+    for (int row = 0; row < order.size(); ++row) {
+        rows[row] = *order[row];
+        rowById.insert(rows[row].id, row);
+    }
+
+    QModelIndexList moved;
+    moved.reserve(persistent.size());
+    for (int i = 0; i < persistent.size(); ++i) {
+        const int row = rowById.value(persistentIds[i], -1);
+        moved.append(row < 0 ? QModelIndex() : index(row, persistent[i].column()));
+    }
+    changePersistentIndexList(persistent, moved);
+    emit layoutChanged();
+
+    // Представление перерисует только видимую часть диапазона
+    if (!rows.isEmpty()) {
+        emit dataChanged(index(0, 0), index(rows.size() - 1, ColumnCount - 1));
+    }
+}
+
+int FleetModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : rows.size();
+}
+
+int FleetModel::columnCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant FleetModel::data(const QModelIndex &index, int role) const
+{
+    const HostSummary *host = hostAt(index.row());
+    if (!host) {
+        return QVariant();
+    }
+
+    const bool silent = refreshedAtMs - host->lastSeenMs > SILENT_AFTER_MS;
+    if (role == Qt::ForegroundRole && silent) {
+        return QBrush(QColor(150, 150, 150));
+    }
+    if (role == Qt::TextAlignmentRole && index.column() != HostColumn) {
+        return int(Qt::AlignRight | Qt::AlignVCenter);
+    }
+    if (role != Qt::DisplayRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+    case RankColumn:
+        return index.row() + 1;
+    case HostColumn:
+        return host->id;
+    case CurrentColumn:
+        return QString::number(host->current, 'f', 1);
+    case AverageColumn:
+        return QString::number(host->windowAverage, 'f', 1);
+    case LastSeenColumn:
+        return QString("%1 s").arg(qMax<qint64>(0, refreshedAtMs - host->lastSeenMs) / 1000);
+    case AnomaliesColumn:
+        return host->anomalies;
+    default:
+        return QVariant();
+    }
+}
+
+QVariant FleetModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (section) {
+    case RankColumn:
+        return "#";
+    case HostColumn:
+        return "Host";
+    case CurrentColumn:
+        return "Total %";
+    case AverageColumn:
+        return QString("Avg (last %1) %").arg(HostSummary::TREND_POINTS);
+    case LastSeenColumn:
+        return "Last seen";
+    case AnomaliesColumn:
+        return "Anomalies";
+    case TrendColumn:
+        return "Trend";
+    default:
+        return QVariant();
+    }
+}
+
+void FleetTrendDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option,
+                               const QModelIndex &index) const
+{
+    QStyledItemDelegate::paint(painter, option, index);
+
+    const FleetModel *model = qobject_cast<const FleetModel*>(index.model());
+    const HostSummary *host = model ? model->hostAt(index.row()) : nullptr;
+    if (!host || host->trendSize() < 2) {
+        return;
+    }
+
+    // Ось Y фиксирована 0..100%, ось X — слоты тренда
+    const QRectF area = QRectF(option.rect).adjusted(2, 2, -2, -2);
+    const double xStep = area.width() / (HostSummary::TREND_POINTS - 1);
+    const int offset = HostSummary::TREND_POINTS - host->trendSize();
+
+    QPolygonF line;
+    line.reserve(host->trendSize());
+    for (int i = 0; i < host->trendSize(); ++i) {
+        const double value = qBound(0.0, static_cast<double>(host->trendAt(i)), 100.0);
+        line.append(QPointF(area.left() + (offset + i) * xStep, area.bottom() - value / 100.0 * area.height()));
+    }
+
+    painter->save();
+    painter->setPen(QPen(QColor(30, 90, 180), 0));
+    painter->drawPolyline(line);
+    painter->restore();
+}
@@ -0,0 +1,64 @@
+#ifndef FLEETVIEW_H
+#define FLEETVIEW_H
+
+#include <QAbstractTableModel>
+#include <QStyledItemDelegate>
+#include <QVector>
+#include "fleetranking.h"
+
+// Таблица обзора парка поверх FleetRanking. Строка — место в рейтинге;
+// порядок и значения снимаются вместе в refresh(), поэтому до следующего
+// снимка столбец «#» монотонен. Выделение следует за хостом, а не за номером строки.
+class FleetModel : public QAbstractTableModel
+{
+    Q_OBJECT
+
+public:
+    enum Column {
+        RankColumn,
+        HostColumn,
+        CurrentColumn,
+        AverageColumn,
+        LastSeenColumn,
+        AnomaliesColumn,
+        TrendColumn,
+        ColumnCount
+    };
+
+    explicit FleetModel(const FleetRanking &ranking, QObject *parent = nullptr);
+
+    void setKey(FleetRanking::Key key);
+    FleetRanking::Key key() const { return rankKey; }
+    // Снимает текущий порядок и сводки хостов; nowMs — для столбца «последний сэмпл»
+    void refresh(qint64 nowMs);
+    const HostSummary *hostAt(int row) const { return row >= 0 && row < rows.size() ? &rows[row] : nullptr; }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    // Хост, молчащий дольше, показывается серым
+    static constexpr qint64 SILENT_AFTER_MS = 10000;
+
+    const FleetRanking &ranking;
+    FleetRanking::Key rankKey = FleetRanking::Key::Current;
+    QVector<HostSummary> rows;          // копии сводок на момент снимка
+    QVector<const HostSummary*> order;  // буфер порядка из FleetRanking
+    qint64 refreshedAtMs = 0;
+};
+
+// Рисует тренд общей загрузки хоста в ячейке прямо из сводки
+class FleetTrendDelegate : public QStyledItemDelegate
+{
+    Q_OBJECT
+
+public:
+    using QStyledItemDelegate::QStyledItemDelegate;
+
+    void paint(QPainter *painter, const QStyleOptionViewItem &option,
+               const QModelIndex &index) const override;
+};
+
+#endif // FLEETVIEW_H
@@ -0,0 +1,353 @@
+// cpu-loadgen — синтетическая нагрузка для cpu-server.
+// Имитирует N хостов по M ядер, отправляющих сэмплы с заданной частотой
+// в текстовом формате (с заголовками Host:, Seq: и при необходимости Frag: и Topo:,
+// а с --channels — с разбивкой user/sys/iowait/steal/irq и частотой по ядрам).
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QHostAddress>
+#include <QRandomGenerator>
+#include <QTimer>
+#include <QUdpSocket>
+#include <QVector>
+#include <QtMath>
+#include <cstdio>
+
+namespace {
+
+// Должно совпадать с MAX_UDP_DATAGRAM_SIZE сервера
+constexpr int MAX_DATAGRAM_SIZE = 4096;
+// Запас под заголовки Host:/Seq:/Frag:/Total: во фрагменте
+constexpr int FRAGMENT_HEADER_RESERVE = 160;
+// Должно совпадать с CpuProtocol::MAX_FRAGMENTS и MAX_CORES сервера
+constexpr int MAX_FRAGMENTS = 64;
+constexpr int MAX_CORES = 4096;
+// Хосты каждого тика распределяются по стольким интервалам, чтобы не отправлять
+// все датаграммы одной пачкой и не переполнять буфер сокета
+constexpr int SLICES_PER_TICK = 10;
+// Топология не меняется, поэтому отправляется раз в столько сэмплов
+constexpr quint32 TOPOLOGY_INTERVAL = 60;
+
+// Реалистичная форма загрузки ядра: базовый уровень, медленная волна,
+// случайное блуждание и редкие всплески до 100% (например, зависший поток)
+struct CoreWaveform
+{
+    double base;
+    double amplitude;
+    double periodSec;
+    double phase;
+    double walk = 0.0;
+    double burstUntilSec = 0.0;
+
+    double next(double timeSec, QRandomGenerator &rng)
+    {
+        walk = qBound(-15.0, walk + (rng.generateDouble() - 0.5) * 4.0, 15.0);
+
+        if (timeSec >= burstUntilSec && rng.generateDouble() < 0.0005) {
+            burstUntilSec = timeSec + 5.0 + rng.generateDouble() * 25.0;
+        }
+        if (timeSec < burstUntilSec) {
+            return 95.0 + rng.generateDouble() * 5.0;
+        }
+
+        const double wave = amplitude * qSin(2.0 * M_PI * timeSec / periodSec + phase);
+        const double noise = (rng.generateDouble() - 0.5) * 6.0;
+        return qBound(0.0, base + wave + walk + noise, 100.0);
+    }
+};
+
+// Наибольшее число ядер, которое гарантированно укладывается в MAX_FRAGMENTS
+// фрагментов. Все строки не длиннее самой длинной возможной, а фрагмент
+// заполняется строками, пока они помещаются, поэтому в нем не меньше
+// budget / longest ядер.
+int maxCoresPerHost(bool channels, bool topology)
+{
+    QByteArray longest = "Core 4095: 100.0%\n";
+    if (channels) {
+        longest += " user=100.0 sys=20.0 iowait=2.0 steal=0.5 irq=3.0 freq=3500";
+    }
+    if (topology) {
+        longest += "4095.4095.4095 ";
+    }
+    const int coresPerFragment = (MAX_DATAGRAM_SIZE - FRAGMENT_HEADER_RESERVE) / longest.size();
+    return qMin(MAX_CORES, MAX_FRAGMENTS * coresPerFragment);
+}
+
+struct SimulatedHost
+{
+    QByteArray name;
+    quint32 sequence = 0;
+    QVector<CoreWaveform> cores;
+    QVector<double> usages;
+    QByteArray topology;         // токены Topo: подряд, пусто — без топологии
+    QVector<int> topologyOffsets;
+};
+
+class LoadGenerator
+{
+public:
+    LoadGenerator(int hostCount, int coreCount, int socketCount, bool channels, double lossRatio)
+        : lossRatio(lossRatio)
+        , channels(channels)
+        , rng(QRandomGenerator::securelySeeded())
+    {
+        hosts.resize(hostCount);
+        for (int h = 0; h < hostCount; ++h) {
+            SimulatedHost &host = hosts[h];
+            host.name = QByteArray("loadgen-") + QByteArray::number(h);
+            // У хостов разная средняя загрузка, чтобы рейтинг и агрегаты были осмысленными
+            const double hostBase = 5.0 + rng.generateDouble() * 60.0;
+            host.cores.reserve(coreCount);
+            for (int c = 0; c < coreCount; ++c) {
+                host.cores.append(CoreWaveform{
+                    qBound(0.0, hostBase + (rng.generateDouble() - 0.5) * 20.0, 100.0),
+                    5.0 + rng.generateDouble() * 20.0,
+                    30.0 + rng.generateDouble() * 270.0,
+                    rng.generateDouble() * 2.0 * M_PI});
+            }
+            host.usages.resize(coreCount);
+            if (socketCount > 0) {
+                buildTopology(host, socketCount);
+            }
+        }
+    }
+
+    void sendSlice(int slice, double timeSec, QUdpSocket &socket, const QHostAddress &address, quint16 port)
+    {
+        for (int h = slice; h < hosts.size(); h += SLICES_PER_TICK) {
+            sendHost(hosts[h], timeSec, socket, address, port);
+        }
+    }
+
+    quint64 sentDatagrams = 0;
+    quint64 sentBytes = 0;
+    quint64 droppedDatagrams = 0;
+
+private:
+    // Нумерация как в Linux: сначала по одному потоку каждого физического ядра
+    // всех сокетов, затем SMT-соседи; один NUMA-узел на сокет
+    static void buildTopology(SimulatedHost &host, int socketCount)
+    {
+        const int coreCount = host.cores.size();
+        const int physicalCount = coreCount % 2 == 0 ? coreCount / 2 : coreCount;
+        const int perSocket = qMax(1, (physicalCount + socketCount - 1) / socketCount);
+        for (int c = 0; c < coreCount; ++c) {
+            const int physical = c % physicalCount;
+            const int socket = physical / perSocket;
+            host.topologyOffsets.append(host.topology.size());
+            host.topology += QByteArray::number(socket) + "." + QByteArray::number(socket) + "."
+                             + QByteArray::number(physical % perSocket) + " ";
+        }
+        host.topologyOffsets.append(host.topology.size());
+    }
+
+    void sendHost(SimulatedHost &host, double timeSec, QUdpSocket &socket,
+                  const QHostAddress &address, quint16 port)
+    {
+        double total = 0.0;
+        for (int c = 0; c < host.cores.size(); ++c) {
+            host.usages[c] = host.cores[c].next(timeSec, rng);
+            total += host.usages[c];
+        }
+        total /= qMax(1, host.cores.size());
+
+        const quint32 sequence = host.sequence++;
+
+        // Сначала пробуем уложить весь сэмпл в одну датаграмму
+        coreLines.clear();
+        lineOffsets.clear();
+        for (int c = 0; c < host.usages.size(); ++c) {
+            lineOffsets.append(coreLines.size());
+            coreLines += "Core " + QByteArray::number(c) + ": "
+                         + QByteArray::number(host.usages[c], 'f', 1) + "%";
+            if (channels) {
+                appendChannels(host.usages[c]);
+            }
+            coreLines += "\n";
+        }
+        lineOffsets.append(coreLines.size());
+
+        const QByteArray header = "Host: " + host.name + "\nSeq: " + QByteArray::number(sequence) + "\n";
+        const QByteArray totalLine = "Total: " + QByteArray::number(total, 'f', 1) + "%\n";
+        const bool withTopology = !host.topology.isEmpty() && sequence % TOPOLOGY_INTERVAL == 0;
+        auto topologyLine = [&](int begin, int end) -> QByteArray {
+            if (!withTopology) {
+                return QByteArray();
+            }
+            return "Topo: " + host.topology.mid(host.topologyOffsets[begin],
+                                                host.topologyOffsets[end] - host.topologyOffsets[begin]) + "\n";
+        };
+        auto topologySize = [&](int begin, int end) {
+            return withTopology ? host.topologyOffsets[end] - host.topologyOffsets[begin] : 0;
+        };
+
+        const QByteArray fullTopology = topologyLine(0, host.usages.size());
+        if (header.size() + fullTopology.size() + totalLine.size() + coreLines.size() <= MAX_DATAGRAM_SIZE) {
+            send(header + fullTopology + totalLine + coreLines, socket, address, port);
+            return;
+        }
+
+        // Не помещается: режем по границам строк на фрагменты
+        QVector<QPair<int, int>> ranges; // [первое ядро, конец)
+        const int budget = MAX_DATAGRAM_SIZE - FRAGMENT_HEADER_RESERVE;
+        int first = 0;
+        while (first < host.usages.size()) {
+            int last = first + 1;
+            while (last < host.usages.size()
+                   && lineOffsets[last + 1] - lineOffsets[first] + topologySize(first, last + 1) <= budget) {
+                ++last;
+            }
+            ranges.append(qMakePair(first, last));
+            first = last;
+        }
+        if (ranges.size() > MAX_FRAGMENTS) {
+            // Не должно случаться: число ядер ограничено maxCoresPerHost()
+            ++droppedDatagrams;
+            return;
+        }
+
+        for (int f = 0; f < ranges.size(); ++f) {
+            const int begin = ranges[f].first;
+            const int end = ranges[f].second;
+            QByteArray datagram = header;
+            datagram += "Frag: " + QByteArray::number(sequence) + " " + QByteArray::number(f) + "/"
+                        + QByteArray::number(ranges.size()) + " " + QByteArray::number(begin) + " "
+                        + QByteArray::number(host.usages.size()) + "\n";
+            datagram += topologyLine(begin, end);
+            if (f == 0) {
+                datagram += totalLine;
+            }
+            datagram += coreLines.mid(lineOffsets[begin], lineOffsets[end] - lineOffsets[begin]);
+            send(datagram, socket, address, port);
+        }
+    }
+
+    // Правдоподобная разбивка загрузки: в основном user, доля sys и irq,
+    // немного iowait и steal; частота растет с загрузкой
+    void appendChannels(double usage)
+    {
+        const double irq = usage * 0.03;
+        const double sys = usage * 0.2;
+        const double iowait = qMin(usage - sys - irq, rng.generateDouble() * 2.0);
+        const double steal = qMin(usage - sys - irq - iowait, rng.generateDouble() * 0.5);
+        const double user = usage - sys - irq - iowait - steal;
+        coreLines += " user=" + QByteArray::number(user, 'f', 1) + " sys=" + QByteArray::number(sys, 'f', 1)
+                     + " iowait=" + QByteArray::number(iowait, 'f', 1) + " steal=" + QByteArray::number(steal, 'f', 1)
+                     + " irq=" + QByteArray::number(irq, 'f', 1)
+                     + " freq=" + QByteArray::number(1200.0 + usage * 23.0, 'f', 0);
+    }
+
+    void send(const QByteArray &datagram, QUdpSocket &socket, const QHostAddress &address, quint16 port)
+    {
+        // Имитация потерь в сети для проверки учета Seq на сервере
+        if (lossRatio > 0.0 && rng.generateDouble() < lossRatio) {
+            ++droppedDatagrams;
+            return;
+        }
+        if (socket.writeDatagram(datagram, address, port) == datagram.size()) {
+            ++sentDatagrams;
+            sentBytes += datagram.size();
+        }
+    }
+
+    double lossRatio;
+    bool channels;
+    QRandomGenerator rng;
+    QVector<SimulatedHost> hosts;
+    QByteArray coreLines;
+    QVector<int> lineOffsets;
+};
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("cpu-loadgen");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Synthetic load generator for cpu-server");
+    parser.addHelpOption();
+    QCommandLineOption hostsOption({"n", "hosts"}, "Number of simulated hosts.", "count", "1");
+    QCommandLineOption coresOption({"m", "cores"}, "Cores per host.", "count", "8");
+    QCommandLineOption rateOption({"r", "rate"}, "Samples per second per host.", "hz", "1");
+    QCommandLineOption durationOption({"d", "duration"}, "Run time in seconds (0 = forever).", "sec", "0");
+    QCommandLineOption addressOption("address", "Server address.", "addr", "127.0.0.1");
+    QCommandLineOption portOption("port", "Server UDP port.", "port", "1234");
+    QCommandLineOption lossOption("loss", "Fraction of datagrams to drop on purpose.", "ratio", "0");
+    QCommandLineOption socketsOption("sockets", "Send a topology map with this many sockets (0 = none).",
+                                     "count", "0");
+    QCommandLineOption channelsOption("channels", "Send user/sys/iowait/steal/irq and frequency per core.");
+    parser.addOptions({hostsOption, coresOption, rateOption, durationOption,
+                       addressOption, portOption, lossOption, socketsOption, channelsOption});
+    parser.process(app);
+
+    const int hostCount = parser.value(hostsOption).toInt();
+    const int coreCount = parser.value(coresOption).toInt();
+    const double rate = parser.value(rateOption).toDouble();
+    const double duration = parser.value(durationOption).toDouble();
+    const QHostAddress address(parser.value(addressOption));
+    const quint16 port = static_cast<quint16>(parser.value(portOption).toUInt());
+    const double loss = parser.value(lossOption).toDouble();
+    const int socketCount = parser.value(socketsOption).toInt();
+    const bool channels = parser.isSet(channelsOption);
+
+    if (hostCount <= 0 || coreCount <= 0 || coreCount > MAX_CORES || rate <= 0.0 || address.isNull()
+        || socketCount < 0 || socketCount > coreCount) {
+        fprintf(stderr, "Invalid arguments, see --help\n");
+        return 1;
+    }
+    // С каналами и топологией строки длиннее: сэмпл не должен требовать больше фрагментов,
+    // чем принимает сервер
+    const int maxCores = maxCoresPerHost(channels, socketCount > 0);
+    if (coreCount > maxCores) {
+        fprintf(stderr, "Too many cores for %d fragments with these options: %d > %d\n",
+                MAX_FRAGMENTS, coreCount, maxCores);
+        return 1;
+    }
+
+    QUdpSocket socket;
+    LoadGenerator generator(hostCount, coreCount, socketCount, channels, loss);
+
+    QElapsedTimer clock;
+    clock.start();
+
+    // Тик делится на SLICES_PER_TICK интервалов, в каждом отправляется своя часть хостов
+    const double sliceMs = 1000.0 / rate / SLICES_PER_TICK;
+    qint64 sliceIndex = 0;
+    QTimer sendTimer;
+    sendTimer.setTimerType(Qt::PreciseTimer);
+    QObject::connect(&sendTimer, &QTimer::timeout, [&]() {
+        // Догоняем пропущенные интервалы, если цикл событий задержался
+        const qint64 dueSlices = static_cast<qint64>(clock.elapsed() / sliceMs);
+        while (sliceIndex <= dueSlices) {
+            generator.sendSlice(static_cast<int>(sliceIndex % SLICES_PER_TICK),
+                                sliceIndex * sliceMs / 1000.0, socket, address, port);
+            ++sliceIndex;
+        }
+    });
+    sendTimer.start(qMax(1, static_cast<int>(sliceMs)));
+
+    quint64 lastSent = 0;
+    QTimer reportTimer;
+    QObject::connect(&reportTimer, &QTimer::timeout, [&]() {
+        printf("%lld s: %llu datagrams/s, %llu sent, %llu dropped on purpose, %.1f MB\n",
+               static_cast<long long>(clock.elapsed() / 1000),
+               static_cast<unsigned long long>(generator.sentDatagrams - lastSent),
+               static_cast<unsigned long long>(generator.sentDatagrams),
+               static_cast<unsigned long long>(generator.droppedDatagrams),
+               generator.sentBytes / (1024.0 * 1024.0));
+        fflush(stdout);
+        lastSent = generator.sentDatagrams;
+
+        if (duration > 0.0 && clock.elapsed() >= duration * 1000.0) {
+            app.quit();
+        }
+    });
+    reportTimer.start(1000);
+
+    printf("Simulating %d hosts x %d cores at %.2f Hz -> %s:%u\n",
+           hostCount, coreCount, rate, qPrintable(address.toString()), port);
+    return app.exec();
+}
@@ -1,11 +1,219 @@
 #include "mainwindow.h"
+#include "cpuingest.h"
+#include "replaysource.h"
+#include "tracing.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
+#include <QScopedPointer>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+bool hasArgument(int argc, char *argv[], const char *name)
+{
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], name) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Воспроизведение записи только через ядро (разбор, сборка, история) без отрисовки.
+// Позволяет отделить стоимость приема от стоимости GUI.
+int runHeadlessReplay(QCoreApplication &app, const QString &path, double speed)
+{
+    // Та же глубина истории, что и в GUI, чтобы замер приема был сопоставим
+    CpuIngest ingest(MainWindow::MAX_HISTORY_POINTS);
+    ReplaySource replay;
+    QString error;
+    if (!replay.open(path, &error)) {
+        qCritical("Failed to open capture file %s: %s", qPrintable(path), qPrintable(error));
+        return 1;
+    }
+
+    quint64 invalid = 0;
+    IngestResult result;
+    QObject::connect(&replay, &ReplaySource::datagramReady, &app,
+                     [&](const QByteArray &data, const QString &sender, qint64 receiveTimeMs) {
+                         if (ingest.processDatagram(data, sender, receiveTimeMs, result)
+                             == CpuIngest::Status::Invalid) {
+                             ++invalid;
+                         }
+                     });
+    QObject::connect(&replay, &ReplaySource::finished, &app,
+                     [&](quint64 datagrams, qint64 elapsedMs) {
+                         const SequenceStats stats = ingest.sequenceStats();
+                         printf("%llu datagrams in %lld ms (%.0f datagrams/s), %d hosts, "
+                                "%llu invalid, %llu lost, %llu incomplete samples\n",
+                                static_cast<unsigned long long>(datagrams),
+                                static_cast<long long>(elapsedMs),
+                                elapsedMs > 0 ? datagrams * 1000.0 / elapsedMs : 0.0,
+                                static_cast<int>(ingest.hosts().size()),
+                                static_cast<unsigned long long>(invalid),
+                                static_cast<unsigned long long>(stats.lost),
+                                static_cast<unsigned long long>(ingest.incompleteSamples()));
+                         app.quit();
+                     });
+
+    replay.start(speed);
+    return app.exec();
+}
+
+} // namespace
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    // Без GUI виджеты не создаются, поэтому хватает QCoreApplication
+    const bool headless = hasArgument(argc, argv, "--headless");
+    QScopedPointer<QCoreApplication> a(headless ? new QCoreApplication(argc, argv)
+                                                : new QApplication(argc, argv));
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("CPU usage monitor (UDP: localhost:1234)");
+    parser.addHelpOption();
+    QCommandLineOption captureOption("capture", "Record every received datagram to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Replay a capture <file> instead of listening on UDP.", "file");
+    QCommandLineOption speedOption("replay-speed",
+                                   "Replay speed: 1 for real time, N for N times faster, "
+                                   "'max' for as fast as possible.", "speed", "1");
+    QCommandLineOption quitOption("quit-after-replay", "Exit when the replay has finished.");
+    QCommandLineOption headlessOption("headless",
+                                      "Replay through the ingest core only, without a window "
+                                      "(requires --replay).");
+    QCommandLineOption traceOption("trace", "Enable hot-path tracing from startup.");
+    QCommandLineOption traceFileOption("trace-file",
+                                       "Chrome trace JSON written on exit, on Ctrl+Shift+D "
+                                       "and on SIGUSR1.", "file", "cpu-server-trace.json");
+    QCommandLineOption threadedRenderOption("threaded-render",
+                                            "Render the plot on a background thread "
+                                            "(toggle with Ctrl+Shift+R).");
+    QCommandLineOption frameBudgetOption("frame-budget",
+                                         "Replot time in ms above which render quality "
+                                         "is lowered automatically.", "ms", "16");
+    QCommandLineOption stripChartOption("strip-chart",
+                                        "Draw the plot as a scrolling strip chart "
+                                        "(toggle with Ctrl+Shift+S).");
+    QCommandLineOption alertOption("alert",
+                                   "Alert rule, e.g. 'core > 95 for 30s', 'total > 80 avg 5m', "
+                                   "'spread > 60 for 30s', 'gini > 0.5 avg 1m', 'missing 10s'; "
+                                   "optional 'clear N' sets the resolve threshold. "
+                                   "Repeatable; replaces the default rules.", "rule");
+    QCommandLineOption alertLogOption("alert-log", "Append alert events to <file>.", "file");
+    QCommandLineOption smoothOption("smooth",
+                                    QString("Smooth per-core lines: raw, ema:SECONDS (half-life), "
+                                            "sma:SAMPLES or max:SAMPLES; at most the history "
+                                            "depth (%1).").arg(MainWindow::MAX_HISTORY_POINTS),
+                                    "spec", "raw");
+    QCommandLineOption forecastOption("forecast-horizon",
+                                      QString("Seconds of total-load forecast drawn past the last sample "
+                                              "(0 disables, at most %1).").arg(MainWindow::MAX_FORECAST_HORIZON_SEC),
+                                      "seconds", "180");
+    parser.addOptions({captureOption, replayOption, speedOption, quitOption, headlessOption,
+                       traceOption, traceFileOption, threadedRenderOption, stripChartOption, frameBudgetOption,
+                       alertOption, alertLogOption, smoothOption, forecastOption});
+    parser.process(*a);
+
+    // Трассировку можно включить и переменной окружения CPU_SERVER_TRACE=1
+    const QString traceFile = parser.value(traceFileOption);
+    const bool traceOnStart = parser.isSet(traceOption) || qEnvironmentVariableIntValue("CPU_SERVER_TRACE") != 0;
+    if (traceOnStart) {
+        Tracing::setEnabled(true);
+    }
+    Tracing::installDumpSignalHandler(traceFile);
+
+    double speed = 1.0;
+    if (parser.isSet(replayOption)) {
+        const QString speedText = parser.value(speedOption);
+        bool ok = true;
+        speed = speedText == "max" ? 0.0 : speedText.toDouble(&ok);
+        if (!ok || speed < 0.0) {
+            qCritical("Invalid replay speed: %s", qPrintable(speedText));
+            return 1;
+        }
+    }
+
+    if (headless) {
+        if (!parser.isSet(replayOption)) {
+            qCritical("--headless requires --replay");
+            return 1;
+        }
+        const int status = runHeadlessReplay(*a, parser.value(replayOption), speed);
+        if (traceOnStart) {
+            Tracing::writeChromeTrace(traceFile);
+        }
+        return status;
+    }
+
     MainWindow w;
+    w.setTraceFile(traceFile);
+    bool budgetOk = false;
+    const double frameBudget = parser.value(frameBudgetOption).toDouble(&budgetOk);
+    if (!budgetOk || frameBudget <= 0.0) {
+        qCritical("Invalid frame budget: %s", qPrintable(parser.value(frameBudgetOption)));
+        return 1;
+    }
+    w.setFrameBudget(frameBudget);
+
+    if (parser.isSet(stripChartOption)) {
+        w.setPlotMode(MainWindow::PlotMode::StripChart);
+    } else if (parser.isSet(threadedRenderOption)) {
+        w.setPlotMode(MainWindow::PlotMode::Threaded);
+    }
+
+    bool horizonOk = false;
+    const double forecastHorizon = parser.value(forecastOption).toDouble(&horizonOk);
+    if (!horizonOk || !(forecastHorizon >= 0.0 && forecastHorizon <= MainWindow::MAX_FORECAST_HORIZON_SEC)) {
+        qCritical("Invalid forecast horizon: %s", qPrintable(parser.value(forecastOption)));
+        return 1;
+    }
+    w.setForecastHorizon(forecastHorizon);
+
+    DerivedSpec smoothing;
+    QString smoothingError;
+    if (!DerivedSpec::parse(parser.value(smoothOption), smoothing, MainWindow::MAX_HISTORY_POINTS, &smoothingError)) {
+        qCritical("%s", qPrintable(smoothingError));
+        return 1;
+    }
+    w.setSmoothing(smoothing);
+
+    if (parser.isSet(alertOption)) {
+        QVector<AlertRule> rules;
+        for (const QString &text : parser.values(alertOption)) {
+            AlertRule rule;
+            QString error;
+            if (!AlertRule::parse(text, rule, &error)) {
+                qCritical("%s", qPrintable(error));
+                return 1;
+            }
+            rules.append(rule);
+        }
+        w.setAlertRules(rules);
+    }
+    if (parser.isSet(alertLogOption) && !w.startAlertLog(parser.value(alertLogOption))) {
+        return 1;
+    }
+
+    if (parser.isSet(captureOption) && !w.startCapture(parser.value(captureOption))) {
+        return 1;
+    }
+
+    if (parser.isSet(replayOption)) {
+        if (parser.isSet(quitOption)) {
+            QObject::connect(&w, &MainWindow::replayFinished, a.data(), &QCoreApplication::quit,
+                             Qt::QueuedConnection);
+        }
+        if (!w.startReplay(parser.value(replayOption), speed)) {
+            return 1;
+        }
+    }
+
     w.show();
-    return a.exec();
+    const int status = a->exec();
+    if (Tracing::isEnabled()) {
+        Tracing::writeChromeTrace(traceFile);
+    }
+    return status;
 }
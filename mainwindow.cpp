@@ -1,27 +1,91 @@
 #include "mainwindow.h"
+#include "cpumonitorlog.h"
+#include "perfcounters.h"
 #include "qcustomplot.h"
+#include "tracing.h"
 #include <QHeaderView>
-#include <QRegularExpression>
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QDateTime>
 #include <QLoggingCategory>
-#include <numeric>
+#include <QFontDatabase>
+#include <QShortcut>
+#include <QDoubleSpinBox>
+#include <QShowEvent>
+#include <QSignalBlocker>
+#include <QSplitter>
+#include <QStatusBar>
+#include <QTabBar>
+#include <QTreeWidget>
+#include <cmath>
+
+namespace {
+
+// Прореживание для графиков: точки группируются по интервалам времени
+// floor(t / bucketSec), поэтому границы групп не сдвигаются с приходом новых
+// сэмплов и вытеснением старых, и линия не «дрожит». В starts — индекс первой
+// точки каждой группы и в конце keys.size()
+void decimationGroups(const QVector<double> &keys, double bucketSec, QVector<int> &starts)
+{
+    starts.clear();
+    qint64 previous = 0;
+    for (int i = 0; i < keys.size(); ++i) {
+        const qint64 bucket = static_cast<qint64>(std::floor(keys[i] / bucketSec));
+        if (i == 0 || bucket != previous) {
+            starts.append(i);
+            previous = bucket;
+        }
+    }
+    starts.append(keys.size());
+}
+
+// Из каждой группы остается первый ключ...
+void decimateKeys(QVector<double> &keys, const QVector<int> &starts)
+{
+    const int count = starts.size() - 1;
+    for (int j = 0; j < count; ++j) {
+        keys[j] = keys[starts[j]];
+    }
+    keys.resize(count);
+}
 
-// Категория логирования для отладки
-Q_LOGGING_CATEGORY(cpuMonitor, "app.cpumonitor")
+// ...и максимум значений, чтобы не терять пики; NaN в группе сохраняет разрыв линии
+void decimateMax(QVector<double> &values, const QVector<int> &starts)
+{
+    const int count = starts.size() - 1;
+    for (int j = 0; j < count; ++j) {
+        double maxValue = values[starts[j]];
+        for (int i = starts[j] + 1; i < starts[j + 1] && !std::isnan(maxValue); ++i) {
+            maxValue = std::isnan(values[i]) ? values[i] : qMax(maxValue, values[i]);
+        }
+        values[j] = maxValue;
+    }
+    values.resize(count);
+}
+
+} // namespace
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , udpSocket(new QUdpSocket(this))
     , updateTimer(new QTimer(this))
     , tabWidget(new QTabWidget(this))
+    , tableTab(nullptr)
+    , plotTab(nullptr)
+    , sparklineGrid(new SparklineGrid(this))
     , totalLabel(new QLabel("Total: —"))
+    , packetStatsLabel(new QLabel(this))
     , coresTable(new QTableWidget(0, 2, this))
     , customPlot(new QCustomPlot(this))
     , totalGraph(nullptr)
     , totalCpuIndicator(nullptr)
+    , offscreenPlot(new OffscreenPlotWidget(this))
+    , stripChart(new StripChartWidget(this))
+    , perfOverlay(nullptr)
+    , perfOverlayTimer(new QTimer(this))
+    , ingest(MAX_HISTORY_POINTS)
     , currentTimeSec(QDateTime::currentSecsSinceEpoch())
+    , replaySource(new ReplaySource(this))
 {
     setupUI();
 
@@ -38,19 +102,79 @@ MainWindow::MainWindow(QWidget *parent)
     connect(udpSocket, &QUdpSocket::readyRead, this, &MainWindow::onReadyRead);
 }
 
+bool MainWindow::startCapture(const QString &path)
+{
+    QString error;
+    if (!captureWriter.open(path, &error)) {
+        qCCritical(cpuMonitor) << "Failed to open capture file" << path << ":" << error;
+        return false;
+    }
+    qCInfo(cpuMonitor) << "Recording datagrams to" << path;
+    return true;
+}
+
+bool MainWindow::startAlertLog(const QString &path)
+{
+    QString error;
+    if (!alertLog.open(path, &error)) {
+        qCCritical(cpuMonitor) << "Failed to open alert log" << path << ":" << error;
+        return false;
+    }
+    qCInfo(cpuMonitor) << "Writing alerts to" << path;
+    alertLogFailing = false;
+    return true;
+}
+
+void MainWindow::setAlertRules(const QVector<AlertRule> &rules)
+{
+    alertEngine->setRules(rules);
+    alertTable->setRowCount(0);
+    updateAlertStatus();
+}
+
+bool MainWindow::startReplay(const QString &path, double speed)
+{
+    QString error;
+    if (!replaySource->open(path, &error)) {
+        qCCritical(cpuMonitor) << "Failed to open capture file" << path << ":" << error;
+        return false;
+    }
+
+    // Воспроизведение должно быть детерминированным: живые датаграммы не принимаем,
+    // а ось времени следует за временем записи
+    udpSocket->close();
+    replayMode = true;
+
+    connect(replaySource, &ReplaySource::datagramReady, this,
+            [this](const QByteArray &data, const QString &sender, qint64 receiveTimeMs) {
+                currentReceiveNs = PerfCounters::nowNs();
+                parseAndDisplay(data, sender, receiveTimeMs);
+            });
+    connect(replaySource, &ReplaySource::finished, this,
+            [this](quint64 datagrams, qint64 elapsedMs) {
+                statusBar()->showMessage(QString("Replay finished: %1 datagrams in %2 ms (%3 datagrams/s)")
+                                             .arg(datagrams)
+                                             .arg(elapsedMs)
+                                             .arg(elapsedMs > 0 ? datagrams * 1000.0 / elapsedMs : 0.0, 0, 'f', 0));
+                emit replayFinished(datagrams, elapsedMs);
+            });
+
+    setWindowTitle(QString("CPU Monitor (replay: %1)").arg(path));
+    replaySource->start(speed);
+    return true;
+}
+
 MainWindow::~MainWindow()
 {
     // Удаляем индикатор, если он был создан
     delete totalCpuIndicator;
 }
 
-double MainWindow::calculateTotalCpuUsage(const QVector<double> &cpuUsages)
+double MainWindow::yAxisTickStep(double yMax)
 {
-    if (cpuUsages.isEmpty()) return 0.0;
-
-    // Используем STL алгоритм для лучшей читабельности
-    double sum = std::accumulate(cpuUsages.begin(), cpuUsages.end(), 0.0);
-    return sum / cpuUsages.size();
+    // Шаг делений оси Y — 5% от диапазона, то есть примерно 20 делений,
+    // что удобно для восприятия
+    return qMax(1.0, yMax * 0.05);
 }
 
 double MainWindow::roundToTen(double value)
@@ -88,7 +212,7 @@ QVector<QColor> MainWindow::getDefaultCoreColors() const
     };
 }
 
-QColor MainWindow::getColorForCore(int coreIndex)
+QColor MainWindow::getColorForCore(int coreIndex) const
 {
     QVector<QColor> defaultColors = getDefaultCoreColors();
 
@@ -113,17 +237,101 @@ void MainWindow::setupUI()
     coresTable->setSelectionMode(QAbstractItemView::NoSelection);
     coresTable->verticalHeader()->setVisible(false);
 
-    QWidget *tableTab = new QWidget(this);
+    tableTab = new QWidget(this);
     QVBoxLayout *tableLayout = new QVBoxLayout(tableTab);
     tableLayout->addWidget(totalLabel);
     tableLayout->addWidget(coresTable);
     tableLayout->setContentsMargins(10, 10, 10, 10);
 
+    // === Вкладка: обзор парка ===
+    fleetModel = new FleetModel(ingest.fleet(), this);
+    fleetTable = new QTableView(this);
+    fleetTable->setModel(fleetModel);
+    fleetTable->setItemDelegateForColumn(FleetModel::TrendColumn, new FleetTrendDelegate(fleetTable));
+    fleetTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    fleetTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    fleetTable->setSelectionMode(QAbstractItemView::SingleSelection);
+    // Фиксированная высота строк: представлению не нужно измерять тысячи строк
+    fleetTable->verticalHeader()->setVisible(false);
+    fleetTable->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    fleetTable->verticalHeader()->setDefaultSectionSize(fontMetrics().height() + 6);
+    fleetTable->horizontalHeader()->setSectionResizeMode(FleetModel::HostColumn, QHeaderView::Stretch);
+    fleetTable->horizontalHeader()->resizeSection(FleetModel::TrendColumn, 160);
+    fleetTable->horizontalHeader()->setSortIndicatorShown(true);
+    fleetTable->horizontalHeader()->setSortIndicator(FleetModel::CurrentColumn, Qt::DescendingOrder);
+    connect(fleetTable->horizontalHeader(), &QHeaderView::sectionClicked, this, [this](int section) {
+        if (section == FleetModel::CurrentColumn) {
+            fleetModel->setKey(FleetRanking::Key::Current);
+        } else if (section == FleetModel::AverageColumn) {
+            fleetModel->setKey(FleetRanking::Key::WindowAverage);
+        }
+        // Сортировка возможна только по убыванию загрузки
+        const int keyColumn = fleetModel->key() == FleetRanking::Key::Current ? FleetModel::CurrentColumn
+                                                                              : FleetModel::AverageColumn;
+        fleetTable->horizontalHeader()->setSortIndicator(keyColumn, Qt::DescendingOrder);
+    });
+    // Enter или двойной щелчок — показать хост на остальных вкладках
+    connect(fleetTable, &QTableView::activated, this, &MainWindow::selectFleetHost);
+
+    fleetRefreshTimer = new QTimer(this);
+    connect(fleetRefreshTimer, &QTimer::timeout, this, &MainWindow::refreshFleet);
+    fleetRefreshTimer->start(FLEET_REFRESH_MS);
+
     // === Вкладка 2: Графики ===
-    QWidget *plotTab = new QWidget(this);
+    plotTab = new QWidget(this);
     QVBoxLayout *plotTabLayout = new QVBoxLayout(plotTab);
     plotTabLayout->setContentsMargins(0, 0, 0, 0);
+
+    // Сглаживание линий ядер производным рядом истории
+    QHBoxLayout *smoothingLayout = new QHBoxLayout();
+    smoothingLayout->setContentsMargins(8, 6, 8, 0);
+    smoothingBox = new QComboBox(plotTab);
+    smoothingBox->addItem("Raw", static_cast<int>(DerivedSpec::Kind::None));
+    smoothingBox->addItem("EMA", static_cast<int>(DerivedSpec::Kind::Ema));
+    smoothingBox->addItem("Moving average", static_cast<int>(DerivedSpec::Kind::Sma));
+    smoothingBox->addItem("Moving max", static_cast<int>(DerivedSpec::Kind::MovingMax));
+    // Дробное поле: полураспад EMA задается с шагом 0.01 с, окна — целыми сэмплами
+    smoothingWindowBox = new QDoubleSpinBox(plotTab);
+    smoothingWindowBox->setRange(1, MAX_HISTORY_POINTS);
+    smoothingWindowBox->setDecimals(0);
+    smoothingWindowBox->setValue(10);
+    smoothingWindowBox->setEnabled(false);
+    smoothingLayout->addWidget(new QLabel("Cores:", plotTab));
+    smoothingLayout->addWidget(smoothingBox);
+    smoothingLayout->addWidget(smoothingWindowBox);
+    smoothingLayout->addStretch(1);
+    plotTabLayout->addLayout(smoothingLayout);
+    auto smoothingChanged = [this]() {
+        DerivedSpec spec;
+        spec.kind = static_cast<DerivedSpec::Kind>(smoothingBox->currentData().toInt());
+        // При переходе с EMA на окно дробный полураспад округляется до целых сэмплов
+        const double value = smoothingWindowBox->value();
+        if (spec.kind == DerivedSpec::Kind::Ema) {
+            spec.param = value;
+        } else if (spec.kind != DerivedSpec::Kind::None) {
+            spec.param = qMax(1.0, std::round(value));
+        }
+        setSmoothing(spec);
+    };
+    connect(smoothingBox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, smoothingChanged);
+    connect(smoothingWindowBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, smoothingChanged);
+
     plotTabLayout->addWidget(customPlot);
+    plotTabLayout->addWidget(offscreenPlot);
+    offscreenPlot->hide();
+    connect(offscreenPlot, &OffscreenPlotWidget::frameRequested, this, [this]() {
+        if (plotMode == PlotMode::Threaded && isPlotVisible()) {
+            submitOffscreenFrame();
+        }
+    });
+    plotTabLayout->addWidget(stripChart);
+    stripChart->hide();
+    stripChart->setTimeWindow(X_VISIBLE_MINUTES * 60);
+    connect(stripChart, &StripChartWidget::redrawRequested, this, [this]() {
+        if (plotMode == PlotMode::StripChart && isPlotVisible()) {
+            advanceStripChart();
+        }
+    });
 
     // Настройка графика
     customPlot->xAxis->setLabel("Time");
@@ -150,19 +358,37 @@ void MainWindow::setupUI()
 
     // Инициализация диапазона оси X (последние 5 минут)
     currentTimeSec = QDateTime::currentSecsSinceEpoch();
-    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec);
+    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec + forecastExtentSec());
 
     // Начальный диапазон оси Y
     customPlot->yAxis->setRange(0, 100);
 
+    // Графики и метка общей загрузки создаются на отдельном буферизованном слое:
+    // пока диапазоны осей не меняются, перерисовывается только он, а фон,
+    // сетка и оси берутся из своих буферов
+    customPlot->addLayer("data", customPlot->layer("main"), QCustomPlot::limAbove);
+    dataLayer = customPlot->layer("data");
+    dataLayer->setMode(QCPLayer::lmBuffered);
+    customPlot->setCurrentLayer(dataLayer);
+
     // === УБИРАЕМ ЛЕГЕНДУ ===
     customPlot->legend->setVisible(false);
 
     // График общей нагрузки
     totalGraph = customPlot->addGraph(customPlot->xAxis, customPlot->yAxis);
-    totalGraph->setPen(QPen(QColor(0, 0, 0), 4));
+    totalGraph->setPen(totalPen());
     totalGraph->setVisible(true);
 
+    // Прогноз общей загрузки: пунктир правее последнего сэмпла
+    forecastGraph = customPlot->addGraph(customPlot->xAxis, customPlot->yAxis);
+    forecastGraph->setPen(QPen(QColor(0, 0, 0), 2, Qt::DashLine));
+
+    // Отметки начала аномалий: кружки без линии поверх графиков
+    anomalyGraph = customPlot->addGraph(customPlot->xAxis, customPlot->yAxis);
+    anomalyGraph->setLineStyle(QCPGraph::lsNone);
+    anomalyGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssCircle, QPen(QColor(220, 0, 0), 2),
+                                                  Qt::NoBrush, 11));
+
     // === СОЗДАЕМ ИНДИКАТОР ДЛЯ ПРАВОЙ ОСИ ===
     totalCpuIndicator = new AxisTag(customPlot->yAxis2);
     totalCpuIndicator->setPen(QPen(QColor(0, 0, 0), 2));
@@ -176,9 +402,63 @@ void MainWindow::setupUI()
     customPlot->yAxis->grid()->setVisible(true);
     customPlot->yAxis2->grid()->setVisible(false); // Сетка только для левой оси
 
+    // Статистика доставки датаграмм в строке состояния
+    statusBar()->addPermanentWidget(packetStatsLabel);
+    qualityLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(qualityLabel);
+    qualityLabel->setText(QString("Quality: %1").arg(RenderQuality::levelName(renderQuality.level())));
+    updatePacketStatsLabel();
+
+    setupPerfOverlay();
+
+    // Трассировка: Ctrl+Shift+T — включить/выключить, Ctrl+Shift+D — выгрузить в JSON
+    QShortcut *traceToggle = new QShortcut(QKeySequence("Ctrl+Shift+T"), this);
+    connect(traceToggle, &QShortcut::activated, this, [this]() {
+        Tracing::setEnabled(!Tracing::isEnabled());
+        statusBar()->showMessage(Tracing::isEnabled() ? "Tracing enabled" : "Tracing disabled", 3000);
+    });
+    QShortcut *traceDump = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(traceDump, &QShortcut::activated, this, &MainWindow::dumpTrace);
+
+    // Ctrl+Shift+R — фоновая отрисовка графика, Ctrl+Shift+S — ленточный самописец
+    QShortcut *renderToggle = new QShortcut(QKeySequence("Ctrl+Shift+R"), this);
+    connect(renderToggle, &QShortcut::activated, this, [this]() {
+        setPlotMode(plotMode == PlotMode::Threaded ? PlotMode::Interactive : PlotMode::Threaded);
+        statusBar()->showMessage(plotMode == PlotMode::Threaded ? "Threaded rendering enabled"
+                                                                : "Threaded rendering disabled", 3000);
+    });
+    QShortcut *stripToggle = new QShortcut(QKeySequence("Ctrl+Shift+S"), this);
+    connect(stripToggle, &QShortcut::activated, this, [this]() {
+        setPlotMode(plotMode == PlotMode::StripChart ? PlotMode::Interactive : PlotMode::StripChart);
+        statusBar()->showMessage(plotMode == PlotMode::StripChart ? "Strip chart enabled"
+                                                                  : "Strip chart disabled", 3000);
+    });
+
     // === Объединение вкладок ===
     tabWidget->addTab(tableTab, "CPU Table");
     tabWidget->addTab(plotTab, "QCustomPlot");
+    tabWidget->addTab(sparklineGrid, "Cores");
+    tabWidget->addTab(fleetTable, "Fleet");
+    setupClusterPlot();
+    tabWidget->addTab(clusterPlot, "Cluster");
+    setupPercentileTab();
+    tabWidget->addTab(percentileTab, "Percentiles");
+    setupImbalancePlot();
+    tabWidget->addTab(imbalanceTab, "Imbalance");
+    setupTopologyTab();
+    tabWidget->addTab(topologyTab, "Topology");
+    setupBreakdownTab();
+    tabWidget->addTab(breakdownTab, "Breakdown");
+    setupAlerts();
+    tabWidget->addTab(alertTable, "Alerts");
+    updateAlertStatus();
+    sparklineGrid->setTimeWindow(X_VISIBLE_MINUTES * 60);
+    connect(sparklineGrid, &SparklineGrid::rebuildRequested, this, [this]() {
+        if (isSparklinesVisible()) {
+            advanceSparklines();
+        }
+    });
+    connect(tabWidget, &QTabWidget::currentChanged, this, &MainWindow::catchUpVisibleViews);
     setCentralWidget(tabWidget);
     setWindowTitle("CPU Monitor (UDP: localhost:1234)");
     resize(900, 600);
@@ -186,74 +466,136 @@ void MainWindow::setupUI()
 
 void MainWindow::updateXAxisRange()
 {
-    currentTimeSec = QDateTime::currentSecsSinceEpoch();
-    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec);
-
-    if (!timeHistory.isEmpty()) {
-        // Обновляем ключи для существующих данных
-        for (int i = 0; i < cpuGraphs.size(); ++i) {
-            // проверяем границы
-            if (i >= cpuHistory.size() || cpuHistory[i].isEmpty()) {
-                continue;
-            }
+    TRACE_SCOPE("MainWindow::updateXAxisRange");
 
-            QVector<double> keys;
-            int startIdx = qMax(0, timeHistory.size() - cpuHistory[i].size());
-            for (int j = startIdx; j < timeHistory.size(); ++j) {
-                keys.append(timeHistory[j]);
-            }
-            cpuGraphs[i]->setData(keys, cpuHistory[i]);
-        }
-
-        // Обновляем график общей нагрузки
-        if (!totalCpuHistory.isEmpty()) {
-            QVector<double> totalKeys;
-            int startIdx = qMax(0, timeHistory.size() - totalCpuHistory.size());
-            for (int j = startIdx; j < timeHistory.size(); ++j) {
-                totalKeys.append(timeHistory[j]);
-            }
-            totalGraph->setData(totalKeys, totalCpuHistory);
-
-            // === ОБНОВЛЯЕМ ИНДИКАТОР ===
-            double lastValue = totalCpuHistory.last();
-            totalCpuIndicator->updatePosition(lastValue);
-            totalCpuIndicator->setText(QString::number(lastValue, 'f', 1) + " %");
-        }
+    // Незавершенные сборки фрагментов не должны висеть дольше таймаута
+    if (!replayMode && ingest.expireFragments(QDateTime::currentMSecsSinceEpoch()) > 0) {
+        packetStatsDirty = true;
+    }
+    if (packetStatsDirty) {
+        updatePacketStatsLabel();
+        packetStatsDirty = false;
+    }
 
+    // При воспроизведении время задают записанные датаграммы
+    if (!replayMode) {
+        // Окно сдвигается целыми секундами, чтобы сэмплы внутри секунды
+        // не требовали перерисовки осей
+        currentTimeSec = std::ceil(QDateTime::currentMSecsSinceEpoch() / 1000.0);
+    }
+    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec + forecastExtentSec());
+    if (!replayMode && isSparklinesVisible()) {
+        sparklineGrid->scrollTo(currentTimeSec);
+    }
+    refreshClusterPlot();
+    refreshPercentilePlot();
+    refreshImbalancePlot();
+    refreshTopologyView();
+    refreshBreakdownPlot();
+
+    const HostModel *host = displayedHost();
+    if (!isPlotVisible()) {
+        plotDirty = true;
+    } else if (host && !host->history.isEmpty()) {
+        refreshGraphData();
         updateYAxisRange();
-        customPlot->replot();
+        replotCustomPlot();
     }
 }
 
-void MainWindow::updateYAxisRange()
+void MainWindow::refreshGraphData()
 {
-    double yMax = 0.0;
-    double minVisibleTime = currentTimeSec - X_VISIBLE_MINUTES * 60;
+    const HostModel *host = displayedHost();
+    if (!host || host->history.isEmpty()) {
+        return;
+    }
+    const CpuHistory &history = host->history;
 
-    // Проверяем данные ядер
-    for (int i = 0; i < cpuHistory.size(); ++i) {
-        for (int j = 0; j < cpuHistory[i].size(); ++j) {
-            int timeIndex = timeHistory.size() - cpuHistory[i].size() + j;
-            // Безопасность: проверяем корректность индекса
-            if (timeIndex >= 0 && timeIndex < timeHistory.size()) {
-                double dataTime = timeHistory[timeIndex];
-                if (dataTime >= minVisibleTime) {
-                    yMax = qMax(yMax, cpuHistory[i][j]);
-                }
-            }
+    // Остальные режимы читают историю сами
+    if (plotMode != PlotMode::Interactive) {
+        return;
+    }
+
+    // На самом низком уровне качества точек не больше, чем пикселей по ширине:
+    // группа — интервал времени шириной в пиксель видимого окна. История, которая
+    // и так помещается в ширину, не прореживается
+    const int width = qMax(1, customPlot->axisRect()->width());
+    const bool decimate = renderQuality.level() == RenderQuality::Level::Decimated
+                          && history.size() > width;
+
+    // Буферы переиспользуются между вызовами, поэтому аллокаций почти нет
+    history.copyTimes(graphKeys);
+    if (decimate) {
+        const double bucketSec = (X_VISIBLE_MINUTES * 60 + forecastExtentSec()) / width;
+        decimationGroups(graphKeys, bucketSec, decimationStarts);
+        decimateKeys(graphKeys, decimationStarts);
+    }
+
+    for (int i = 0; i < cpuGraphs.size() && i < history.coreCount(); ++i) {
+        if (history.hasDerived()) {
+            history.copyDerivedCore(i, graphValues);
+        } else {
+            history.copyCore(i, graphValues);
+        }
+        if (decimate) {
+            decimateMax(graphValues, decimationStarts);
         }
+        cpuGraphs[i]->setData(graphKeys, graphValues, true);
     }
 
-    // Проверяем общую нагрузку
-    for (int j = 0; j < totalCpuHistory.size(); ++j) {
-        int timeIndex = timeHistory.size() - totalCpuHistory.size() + j;
-        if (timeIndex >= 0 && timeIndex < timeHistory.size()) {
-            double dataTime = timeHistory[timeIndex];
-            if (dataTime >= minVisibleTime) {
-                yMax = qMax(yMax, totalCpuHistory[j]);
-            }
+    history.copyTotal(graphValues);
+    if (decimate) {
+        decimateMax(graphValues, decimationStarts);
+    }
+    totalGraph->setData(graphKeys, graphValues, true);
+
+    // Отметки аномалий в пределах истории; их не больше AnomalyDetector::MAX_MARKS
+    host->anomalies.copyMarks(history.timeAt(0), anomalyMarks);
+    graphKeys.resize(anomalyMarks.size());
+    graphValues.resize(anomalyMarks.size());
+    for (int i = 0; i < anomalyMarks.size(); ++i) {
+        graphKeys[i] = anomalyMarks[i].timeSec;
+        graphValues[i] = anomalyMarks[i].value;
+    }
+    anomalyGraph->setData(graphKeys, graphValues);
+
+    // Прогноз от последнего сэмпла на forecastHorizonSec вперед; ограничение
+    // 0..100% делает линию ломаной, поэтому она задается несколькими точками
+    graphKeys.clear();
+    graphValues.clear();
+    if (forecastHorizonSec > 0.0 && host->forecaster.isReady()) {
+        // Целый счетчик шагов: последняя точка ровно на горизонте, даже если шаг его не делит
+        const double start = host->forecaster.lastTime();
+        const int steps = static_cast<int>(std::ceil(forecastHorizonSec / FORECAST_STEP_SEC));
+        for (int step = 0; step <= steps; ++step) {
+            const double h = qMin(step * FORECAST_STEP_SEC, forecastHorizonSec);
+            graphKeys.append(start + h);
+            graphValues.append(host->forecaster.forecast(h));
         }
     }
+    forecastGraph->setData(graphKeys, graphValues, true);
+
+    // === ОБНОВЛЯЕМ ИНДИКАТОР ===
+    double lastValue = history.lastTotal();
+    if (!std::isnan(lastValue)) {
+        totalCpuIndicator->updatePosition(lastValue);
+        totalCpuIndicator->setText(QString::number(lastValue, 'f', 1) + " %");
+    }
+}
+
+void MainWindow::updateYAxisRange()
+{
+    TRACE_SCOPE("MainWindow::updateYAxisRange");
+
+    double minVisibleTime = currentTimeSec - X_VISIBLE_MINUTES * 60;
+
+    // Проверяем данные ядер и общую нагрузку в видимом окне
+    const HostModel *host = displayedHost();
+    double yMax = host ? host->history.maxValueSince(minVisibleTime) : 0.0;
+    if (host && forecastHorizonSec > 0.0 && host->forecaster.isReady()) {
+        // Прогноз линейный, поэтому максимум — на одном из концов
+        yMax = qMax(yMax, host->forecaster.forecast(forecastHorizonSec));
+    }
 
     if (yMax < 1e-6) yMax = 0.0;
 
@@ -266,12 +608,13 @@ void MainWindow::updateYAxisRange()
         yMaxWithMargin = MIN_Y_AXIS_RANGE;
     }
 
+    // Диапазон тот же — оставляем и ось, и ticker, иначе оси пришлось бы перерисовать
+    if (customPlot->yAxis->range().upper == yMaxWithMargin) {
+        return;
+    }
     customPlot->yAxis->setRange(0, yMaxWithMargin);
 
-    // Расчет шага делений оси Y (5% от диапазона)
-    // Это обеспечивает примерно 20 делений на оси, что удобно для восприятия
-    double tickStep = yMaxWithMargin * 0.05;
-    if (tickStep < 1) tickStep = 1;
+    double tickStep = yAxisTickStep(yMaxWithMargin);
 
     QSharedPointer<QCPAxisTickerFixed> ticker(new QCPAxisTickerFixed);
     ticker->setTickStep(tickStep);
@@ -281,11 +624,15 @@ void MainWindow::updateYAxisRange()
 
 void MainWindow::onReadyRead()
 {
+    TRACE_SCOPE("MainWindow::onReadyRead");
+
     while (udpSocket->hasPendingDatagrams()) {
         // проверяем размер датаграммы
         qint64 pendingSize = udpSocket->pendingDatagramSize();
         if (pendingSize <= 0 || pendingSize > MAX_UDP_DATAGRAM_SIZE) {
             qCWarning(cpuMonitor) << "Invalid datagram size:" << pendingSize;
+            PerfCounters::add(PerfCounters::global().datagramsReceived);
+            PerfCounters::add(PerfCounters::global().datagramsDropped);
             udpSocket->readDatagram(nullptr, 0); // Сбрасываем пакет
             continue;
         }
@@ -293,153 +640,1343 @@ void MainWindow::onReadyRead()
         QByteArray datagram;
         datagram.resize(static_cast<int>(pendingSize));
 
-        qint64 bytesRead = udpSocket->readDatagram(datagram.data(), datagram.size());
+        QHostAddress senderAddress;
+        quint16 senderPort = 0;
+        qint64 bytesRead = udpSocket->readDatagram(datagram.data(), datagram.size(),
+                                                   &senderAddress, &senderPort);
         if (bytesRead != pendingSize) {
             qCWarning(cpuMonitor) << "Incomplete datagram read:" << bytesRead << "of" << pendingSize;
+            PerfCounters::add(PerfCounters::global().datagramsReceived);
+            PerfCounters::add(PerfCounters::global().datagramsDropped);
             continue;
         }
 
-        parseAndDisplay(datagram);
+        const qint64 receiveTimeMs = QDateTime::currentMSecsSinceEpoch();
+        currentReceiveNs = PerfCounters::nowNs();
+        const QString sender = QString("%1:%2").arg(senderAddress.toString()).arg(senderPort);
+        // Ошибка записи (диск заполнен и т. п.) останавливает запись; чтение файла
+        // остановится на оборванной последней записи
+        if (captureWriter.isOpen() && !captureWriter.write(receiveTimeMs, sender, datagram)) {
+            qCCritical(cpuMonitor) << "Capture write failed after" << captureWriter.recordCount()
+                                   << "datagrams, capture stopped:" << captureWriter.errorString();
+            captureWriter.close();
+        }
+
+        parseAndDisplay(datagram, sender, receiveTimeMs);
     }
 }
 
-void MainWindow::parseAndDisplay(const QByteArray &data)
+void MainWindow::parseAndDisplay(const QByteArray &data, const QString &sender, qint64 receiveTimeMs)
 {
-    QString text = QString::fromUtf8(data).trimmed();
-    QStringList lines = text.split('\n', Qt::SkipEmptyParts);
+    TRACE_SCOPE("MainWindow::parseAndDisplay");
 
-    // базовая проверка формата данных
-    if (lines.isEmpty() || !lines[0].startsWith("Total:")) {
-        qCWarning(cpuMonitor) << "Invalid data format received";
+    IngestResult result;
+    switch (ingest.processDatagram(data, sender, receiveTimeMs, result)) {
+    case CpuIngest::Status::Invalid:
+        qCWarning(cpuMonitor) << ingest.lastError();
+        return;
+    case CpuIngest::Status::Pending:
+        return;
+    case CpuIngest::Status::Stale:
+        packetStatsDirty = true;
         return;
+    case CpuIngest::Status::Accepted:
+        break;
     }
 
-    totalLabel->setText(lines[0].trimmed());
+    lastReceiveTimeMs = receiveTimeMs;
+    alertEngine->addSample(result.host->id, receiveTimeMs / 1000.0, result.sample->coreUsages, result.totalUsage,
+                           result.imbalance);
+    if (result.sample->hasSequence) {
+        packetStatsDirty = true;
+    }
+    displaySample(result);
+}
 
-    int coreCount = lines.size() - 1;
-    if (coreCount <= 0) {
-        qCDebug(cpuMonitor) << "No core data received";
+HostModel *MainWindow::displayedHost() const
+{
+    return ingest.host(displayedHostId);
+}
+
+double MainWindow::forecastExtentSec() const
+{
+    // Ось продлевается, только когда прогноз действительно рисуется: он есть лишь
+    // в QCustomPlot и появляется после прогрева прогнозатора
+    const HostModel *host = displayedHost();
+    if (plotMode != PlotMode::Interactive || !host || !host->forecaster.isReady()) {
+        return 0.0;
+    }
+    return forecastHorizonSec;
+}
+
+void MainWindow::displaySample(const IngestResult &result)
+{
+    // Показываем первый появившийся хост; если он замолчал, переключаемся на активный
+    HostModel *shown = displayedHost();
+    if (!shown || (result.host != shown
+                   && result.host->lastSeenMs - shown->lastSeenMs > HOST_SWITCH_TIMEOUT_MS)) {
+        showHost(result.host);
+        shown = result.host;
+    } else if (result.host != shown) {
         return;
+    } else if (result.coreSetChanged) {
+        applyCoreSet();
     }
 
-    // Инициализация при первом получении данных
-    if (coresTable->rowCount() == 0) {
-        coresTable->setRowCount(coreCount);
-        for (int i = 0; i < coreCount; ++i) {
-            QTableWidgetItem *coreItem = new QTableWidgetItem(QString("Core %1").arg(i));
-            coreItem->setTextAlignment(Qt::AlignCenter);
-            coresTable->setItem(i, 0, coreItem);
+    // Задержка до экрана считается от самого раннего еще не нарисованного сэмпла
+    if (pendingLatencyStartNs == 0) {
+        pendingLatencyStartNs = currentReceiveNs;
+    }
+
+    const CpuSample &sample = *result.sample;
+    if (sample.hasTotal) {
+        totalLabel->setText(QString("Total: %1%").arg(sample.total, 0, 'f', 1));
+    }
 
-            QProgressBar *bar = new QProgressBar();
-            bar->setRange(0, 100);
-            bar->setTextVisible(true);
-            bar->setFormat("%v%");
-            coresTable->setCellWidget(i, 1, bar);
+    // Скрытые вкладки только накапливают данные; перестроение — при показе
+    if (isTableVisible()) {
+        updateCoreBars(sample.coreUsages);
+    } else {
+        tableDirty = true;
+    }
+    if (isSparklinesVisible()) {
+        advanceSparklines();
+    }
+
+    updatePlots();
+}
+
+void MainWindow::updateCoreBars(const QVector<double> &usages)
+{
+    for (int coreIdx = 0; coreIdx < usages.size() && coreIdx < coresTable->rowCount(); ++coreIdx) {
+        qreal usage = usages[coreIdx];
+        if (std::isnan(usage)) {
+            continue;
         }
 
-        cpuHistory.resize(coreCount);
-        for (int i = 0; i < coreCount; ++i) {
-            cpuHistory[i].reserve(MAX_HISTORY_POINTS);
-            QCPGraph *graph = customPlot->addGraph(customPlot->xAxis, customPlot->yAxis);
-            QColor color = getColorForCore(i);
-            graph->setPen(QPen(color, 1));
-            graph->setVisible(true);
-            cpuGraphs.append(graph);
+        QWidget *widget = coresTable->cellWidget(coreIdx, 1);
+        if (!widget) {
+            qCWarning(cpuMonitor) << "No progress bar widget for core" << coreIdx;
+            continue;
         }
 
-        totalCpuHistory.reserve(MAX_HISTORY_POINTS);
-        timeHistory.reserve(MAX_HISTORY_POINTS);
+        if (QProgressBar *bar = qobject_cast<QProgressBar*>(widget)) {
+            bar->setValue(static_cast<int>(usage));
+            // Таблица стилей пересчитывается дорого, меняем ее только при смене цвета
+            QString color = usage > 80 ? "#ff4444" : (usage > 50 ? "#ffaa00" : "#44ff44");
+            if (bar->property("chunkColor").toString() != color) {
+                bar->setProperty("chunkColor", color);
+                bar->setStyleSheet(QString("QProgressBar::chunk { background-color: %1; }").arg(color));
+            }
+        }
     }
+}
+
+bool MainWindow::isPlotVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == plotTab;
+}
 
-    QVector<double> currentUsages(coreCount, 0.0);
+bool MainWindow::isTableVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == tableTab;
+}
 
-    for (int i = 1; i < lines.size() && (i - 1) < coresTable->rowCount(); ++i) {
-        const QString &line = lines[i].trimmed();
-        QRegularExpression re(R"(Core (\d+): ([\d.]+)%)");
-        QRegularExpressionMatch match = re.match(line);
-        if (match.hasMatch()) {
-            int coreIdx = match.captured(1).toInt();
+bool MainWindow::isFleetVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == fleetTable;
+}
 
-            // проверяем индекс ядра
-            if (coreIdx < 0 || coreIdx >= coreCount) {
-                qCWarning(cpuMonitor) << "Invalid core index:" << coreIdx;
-                continue;
-            }
+void MainWindow::refreshFleet()
+{
+    if (!isFleetVisible()) {
+        return;
+    }
+    TRACE_SCOPE("MainWindow::refreshFleet");
+    // При воспроизведении «сейчас» — время последней записанной датаграммы
+    fleetModel->refresh(replayMode ? lastReceiveTimeMs : QDateTime::currentMSecsSinceEpoch());
+}
+
+void MainWindow::selectFleetHost(const QModelIndex &index)
+{
+    const HostSummary *summary = fleetModel->hostAt(index.row());
+    HostModel *host = summary ? ingest.host(summary->id) : nullptr;
+    if (!host || host->id == displayedHostId) {
+        return;
+    }
 
-            qreal usage = match.captured(2).toDouble();
-            currentUsages[coreIdx] = usage;
+    showHost(host);
+    // Остальные вкладки перестроятся из истории выбранного хоста при показе
+    tableDirty = true;
+    plotDirty = true;
+    statusBar()->showMessage(QString("Displaying host %1").arg(host->id), 3000);
+}
 
-            QWidget *widget = coresTable->cellWidget(coreIdx, 1);
-            if (!widget) {
-                qCWarning(cpuMonitor) << "No progress bar widget for core" << coreIdx;
-                continue;
-            }
+bool MainWindow::isClusterVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == clusterPlot;
+}
 
-            if (QProgressBar *bar = qobject_cast<QProgressBar*>(widget)) {
-                bar->setValue(static_cast<int>(usage));
-                QString color = usage > 80 ? "#ff4444" : (usage > 50 ? "#ffaa00" : "#44ff44");
-                bar->setStyleSheet(QString("QProgressBar::chunk { background-color: %1; }").arg(color));
+void MainWindow::setupClusterPlot()
+{
+    clusterPlot = new QCustomPlot(this);
+    clusterPlot->xAxis->setLabel("Time");
+    clusterPlot->yAxis->setLabel("Host total CPU (%)");
+
+    QSharedPointer<QCPAxisTickerDateTime> dateTimeTicker(new QCPAxisTickerDateTime);
+    dateTimeTicker->setDateTimeFormat("HH.mm");
+    dateTimeTicker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    dateTimeTicker->setTickCount(6);
+    clusterPlot->xAxis->setTicker(dateTimeTicker);
+    clusterPlot->yAxis->setRange(0, 100);
+
+    clusterPlot->setBackground(QColor(240, 240, 240));
+    clusterPlot->xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    clusterPlot->yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+
+    clusterMaxGraph = clusterPlot->addGraph();
+    clusterMaxGraph->setName("max");
+    clusterMaxGraph->setPen(QPen(QColor(220, 50, 50), 1));
+
+    clusterP95Graph = clusterPlot->addGraph();
+    clusterP95Graph->setName("p95");
+    clusterP95Graph->setPen(QPen(QColor(255, 150, 0), 2));
+
+    clusterMeanGraph = clusterPlot->addGraph();
+    clusterMeanGraph->setName("mean");
+    clusterMeanGraph->setPen(QPen(QColor(0, 0, 0), 3));
+
+    clusterPlot->legend->setVisible(true);
+    clusterPlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
+}
+
+void MainWindow::refreshClusterPlot()
+{
+    const ClusterAggregator &cluster = ingest.cluster();
+    if (!isClusterVisible() || cluster.isEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("MainWindow::refreshClusterPlot");
+
+    // Буферы переиспользуются; квантили считаются по эскизам корзин
+    cluster.copySeries(clusterTimes, clusterMean, clusterMax, clusterP95);
+    clusterMeanGraph->setData(clusterTimes, clusterMean, true);
+    clusterMaxGraph->setData(clusterTimes, clusterMax, true);
+    clusterP95Graph->setData(clusterTimes, clusterP95, true);
+
+    // При воспроизведении окно заканчивается на последней корзине
+    const double windowEnd = replayMode && !clusterTimes.isEmpty() ? std::ceil(clusterTimes.last()) : currentTimeSec;
+    clusterPlot->xAxis->setRange(windowEnd - X_VISIBLE_MINUTES * 60, windowEnd);
+
+    double yMax = 0.0;
+    for (double value : clusterMax) {
+        yMax = qMax(yMax, value);
+    }
+    const double yMaxWithMargin = qMax(MIN_Y_AXIS_RANGE, roundToTen(yMax * Y_AXIS_MARGIN_FACTOR));
+    clusterPlot->yAxis->setRange(0, yMaxWithMargin);
+
+    clusterPlot->replot();
+}
+
+bool MainWindow::isImbalanceVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == imbalanceTab;
+}
+
+void MainWindow::setupImbalancePlot()
+{
+    imbalanceTab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(imbalanceTab);
+    layout->setContentsMargins(0, 0, 0, 0);
+    hotspotLabel = new QLabel(imbalanceTab);
+    hotspotLabel->setContentsMargins(8, 6, 8, 0);
+    layout->addWidget(hotspotLabel);
+
+    imbalancePlot = new QCustomPlot(imbalanceTab);
+    layout->addWidget(imbalancePlot);
+    imbalancePlot->xAxis->setLabel("Time");
+    imbalancePlot->yAxis->setLabel("Spread / stddev (%)");
+    imbalancePlot->yAxis2->setVisible(true);
+    imbalancePlot->yAxis2->setLabel("Gini");
+    imbalancePlot->yAxis2->setRange(0, 1);
+
+    QSharedPointer<QCPAxisTickerDateTime> dateTimeTicker(new QCPAxisTickerDateTime);
+    dateTimeTicker->setDateTimeFormat("HH.mm");
+    dateTimeTicker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    dateTimeTicker->setTickCount(6);
+    imbalancePlot->xAxis->setTicker(dateTimeTicker);
+    imbalancePlot->yAxis->setRange(0, 100);
+
+    imbalancePlot->setBackground(QColor(240, 240, 240));
+    imbalancePlot->xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    imbalancePlot->yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+
+    imbalanceSpreadGraph = imbalancePlot->addGraph();
+    imbalanceSpreadGraph->setName("max − mean");
+    imbalanceSpreadGraph->setPen(QPen(QColor(220, 50, 50), 2));
+
+    imbalanceStdDevGraph = imbalancePlot->addGraph();
+    imbalanceStdDevGraph->setName("stddev");
+    imbalanceStdDevGraph->setPen(QPen(QColor(255, 150, 0), 1));
+
+    // Джини безразмерный, поэтому на правой оси
+    imbalanceGiniGraph = imbalancePlot->addGraph(imbalancePlot->xAxis, imbalancePlot->yAxis2);
+    imbalanceGiniGraph->setName("Gini");
+    imbalanceGiniGraph->setPen(QPen(QColor(30, 90, 180), 1, Qt::DashLine));
+
+    imbalancePlot->legend->setVisible(true);
+    imbalancePlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
+}
+
+void MainWindow::refreshImbalancePlot()
+{
+    const HostModel *host = displayedHost();
+    if (!isImbalanceVisible() || !host || host->history.isEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("MainWindow::refreshImbalancePlot");
+    const CpuHistory &history = host->history;
+
+    history.copyTimes(graphKeys);
+    history.copyImbalance(CpuHistory::Imbalance::Spread, graphValues);
+    imbalanceSpreadGraph->setData(graphKeys, graphValues, true);
+    double yMax = 0.0;
+    for (double value : graphValues) {
+        yMax = qMax(yMax, value);
+    }
+    history.copyImbalance(CpuHistory::Imbalance::StdDev, graphValues);
+    imbalanceStdDevGraph->setData(graphKeys, graphValues, true);
+    history.copyImbalance(CpuHistory::Imbalance::Gini, graphValues);
+    imbalanceGiniGraph->setData(graphKeys, graphValues, true);
+
+    const double windowEnd = replayMode ? std::ceil(history.lastTime()) : currentTimeSec;
+    imbalancePlot->xAxis->setRange(windowEnd - X_VISIBLE_MINUTES * 60, windowEnd);
+    imbalancePlot->yAxis->setRange(0, qMax(MIN_Y_AXIS_RANGE, roundToTen(yMax * Y_AXIS_MARGIN_FACTOR)));
+
+    // Самое загруженное ядро последнего сэмпла против среднего по хосту
+    const int last = history.size() - 1;
+    const double spread = history.imbalanceAt(CpuHistory::Imbalance::Spread, last);
+    // Ядро уже выбрано CpuAggregates::coreStats при приеме, то же, что в оповещении spread
+    const int hottest = host->lastImbalance.hottestCore;
+    if (!std::isnan(spread) && hottest >= 0 && hottest < history.coreCount()) {
+        hotspotLabel->setText(QString("Hotspot: core %1 at %2%, host average %3%, Gini %4")
+                                  .arg(hottest)
+                                  .arg(history.coreAt(hottest, last), 0, 'f', 1)
+                                  .arg(history.totalAt(last), 0, 'f', 1)
+                                  .arg(history.imbalanceAt(CpuHistory::Imbalance::Gini, last), 0, 'f', 2));
+    }
+
+    imbalancePlot->replot();
+}
+
+bool MainWindow::isTopologyVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == topologyTab;
+}
+
+void MainWindow::setupTopologyTab()
+{
+    topologyTab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(topologyTab);
+    layout->setContentsMargins(0, 0, 0, 0);
+    topologyLabel = new QLabel("No topology reported by this host", topologyTab);
+    topologyLabel->setContentsMargins(8, 6, 8, 0);
+    layout->addWidget(topologyLabel);
+
+    QSplitter *splitter = new QSplitter(Qt::Horizontal, topologyTab);
+    layout->addWidget(splitter);
+
+    // Сокет → узел → физическое ядро → логические ядра; узлы по умолчанию свернуты
+    topologyTree = new QTreeWidget(splitter);
+    topologyTree->setColumnCount(3);
+    topologyTree->setHeaderLabels({"Group", "Usage", "Cores"});
+    topologyTree->header()->setSectionResizeMode(0, QHeaderView::ResizeToContents);
+    topologyTree->setUniformRowHeights(true);
+
+    topologyPlot = new QCustomPlot(splitter);
+    topologyPlot->xAxis->setLabel("Time");
+    topologyPlot->yAxis->setLabel("NUMA node usage (%)");
+    QSharedPointer<QCPAxisTickerDateTime> dateTimeTicker(new QCPAxisTickerDateTime);
+    dateTimeTicker->setDateTimeFormat("HH.mm");
+    dateTimeTicker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    dateTimeTicker->setTickCount(6);
+    topologyPlot->xAxis->setTicker(dateTimeTicker);
+    topologyPlot->yAxis->setRange(0, 100);
+    topologyPlot->setBackground(QColor(240, 240, 240));
+    topologyPlot->xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    topologyPlot->yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    topologyPlot->legend->setVisible(true);
+    topologyPlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
+
+    splitter->setStretchFactor(0, 1);
+    splitter->setStretchFactor(1, 2);
+}
+
+void MainWindow::rebuildTopologyView(const HostModel *host)
+{
+    TRACE_SCOPE("MainWindow::rebuildTopologyView");
+    const TopologyMap &topology = host->topology;
+    using Level = TopologyMap::Level;
+
+    topologyHostId = host->id;
+    topologyRevision = topology.revision();
+    topologyTree->clear();
+    for (QVector<QTreeWidgetItem*> &items : topologyItems) {
+        items.clear();
+    }
+    topologyCoreItems.fill(nullptr, topology.coreCount());
+
+    // Группы каждого уровня упорядочены и вложены, поэтому родитель уже создан
+    auto &sockets = topologyItems[static_cast<int>(Level::Socket)];
+    auto &nodes = topologyItems[static_cast<int>(Level::Node)];
+    auto &physical = topologyItems[static_cast<int>(Level::PhysicalCore)];
+    for (int g = 0; g < topology.groupCount(Level::Socket); ++g) {
+        sockets.append(new QTreeWidgetItem(topologyTree, {topology.groupName(Level::Socket, g)}));
+    }
+    for (int g = 0; g < topology.groupCount(Level::Node); ++g) {
+        nodes.append(new QTreeWidgetItem(sockets[topology.parentOf(Level::Node, g)],
+                                         {topology.groupName(Level::Node, g)}));
+        nodes.last()->setForeground(0, getColorForCore(g));
+    }
+    for (int g = 0; g < topology.groupCount(Level::PhysicalCore); ++g) {
+        physical.append(new QTreeWidgetItem(nodes[topology.parentOf(Level::PhysicalCore, g)],
+                                            {topology.groupName(Level::PhysicalCore, g)}));
+        // Логические ядра физического ядра — SMT-соседи
+        for (int core : topology.members(Level::PhysicalCore, g)) {
+            topologyCoreItems[core] = new QTreeWidgetItem(physical.last(), {QString("Core %1").arg(core)});
+        }
+    }
+    for (int level = 0; level < TopologyMap::LEVEL_COUNT; ++level) {
+        for (int g = 0; g < topologyItems[level].size(); ++g) {
+            topologyItems[level][g]->setText(2, QString::number(topology.members(static_cast<Level>(level), g).size()));
+        }
+    }
+    for (QTreeWidgetItem *item : sockets) {
+        item->setExpanded(true);
+    }
+
+    for (QCPGraph *graph : topologyGraphs) {
+        topologyPlot->removeGraph(graph);
+    }
+    topologyGraphs.clear();
+    for (int g = 0; g < topology.groupCount(Level::Node); ++g) {
+        QCPGraph *graph = topologyPlot->addGraph();
+        graph->setName(topology.groupName(Level::Node, g));
+        graph->setPen(QPen(getColorForCore(g), 2));
+        topologyGraphs.append(graph);
+    }
+
+    topologyLabel->setText(QString("%1 sockets, %2 NUMA nodes, %3 physical cores, %4 logical cores")
+                               .arg(topology.groupCount(Level::Socket))
+                               .arg(topology.groupCount(Level::Node))
+                               .arg(topology.groupCount(Level::PhysicalCore))
+                               .arg(topology.coreCount()));
+}
+
+void MainWindow::refreshTopologyView()
+{
+    const HostModel *host = displayedHost();
+    if (!isTopologyVisible() || !host || host->history.isEmpty()) {
+        return;
+    }
+    if (host->topology.isEmpty()) {
+        if (!topologyHostId.isEmpty()) {
+            topologyHostId.clear();
+            topologyTree->clear();
+            for (QVector<QTreeWidgetItem*> &items : topologyItems) {
+                items.clear();
             }
+            topologyCoreItems.clear();
+            topologyPlot->clearGraphs();
+            topologyGraphs.clear();
+            topologyPlot->replot();
+        }
+        topologyLabel->setText("No topology reported by this host");
+        return;
+    }
+    TRACE_SCOPE("MainWindow::refreshTopologyView");
+
+    const TopologyMap &topology = host->topology;
+    if (host->id != topologyHostId || topology.revision() != topologyRevision) {
+        rebuildTopologyView(host);
+    }
+
+    // Значения дерева — по последнему сэмплу, через те же индексы, что и при приеме
+    const CpuHistory &history = host->history;
+    const int last = history.size() - 1;
+    topologyUsages.resize(history.coreCount());
+    for (int core = 0; core < history.coreCount(); ++core) {
+        topologyUsages[core] = history.coreAt(core, last);
+    }
+    auto usageText = [](double value) {
+        return std::isnan(value) ? QString("offline") : QString("%1%").arg(value, 0, 'f', 1);
+    };
+    for (int level = 0; level < TopologyMap::LEVEL_COUNT; ++level) {
+        topology.aggregate(static_cast<TopologyMap::Level>(level), topologyUsages, topologyValues, topologyCounts);
+        for (int g = 0; g < topologyItems[level].size(); ++g) {
+            topologyItems[level][g]->setText(1, usageText(topologyValues[g]));
+        }
+    }
+    for (int core = 0; core < topologyCoreItems.size(); ++core) {
+        topologyCoreItems[core]->setText(1, usageText(topologyUsages.value(core, std::nan(""))));
+    }
+
+    // Линии по узлам посчитаны при приеме и хранятся в истории узлов
+    const CpuHistory &nodes = host->nodeHistory;
+    if (!nodes.isEmpty()) {
+        nodes.copyTimes(graphKeys);
+        for (int g = 0; g < topologyGraphs.size() && g < nodes.coreCount(); ++g) {
+            nodes.copyCore(g, graphValues);
+            topologyGraphs[g]->setData(graphKeys, graphValues, true);
+        }
+    }
+    const double windowEnd = replayMode ? std::ceil(history.lastTime()) : currentTimeSec;
+    topologyPlot->xAxis->setRange(windowEnd - X_VISIBLE_MINUTES * 60, windowEnd);
+    const double yMax = nodes.isEmpty() ? 0.0 : nodes.maxValueSince(windowEnd - X_VISIBLE_MINUTES * 60);
+    topologyPlot->yAxis->setRange(0, qMax(MIN_Y_AXIS_RANGE, roundToTen(yMax * Y_AXIS_MARGIN_FACTOR)));
+    topologyPlot->replot();
+}
+
+bool MainWindow::isBreakdownVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == breakdownTab;
+}
+
+void MainWindow::setupBreakdownTab()
+{
+    breakdownTab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(breakdownTab);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->setContentsMargins(8, 6, 8, 0);
+    breakdownSeriesBox = new QComboBox(breakdownTab);
+    breakdownLabel = new QLabel("No channel breakdown reported by this host", breakdownTab);
+    controls->addWidget(breakdownSeriesBox);
+    controls->addWidget(breakdownLabel, 1);
+    layout->addLayout(controls);
+
+    breakdownPlot = new QCustomPlot(breakdownTab);
+    layout->addWidget(breakdownPlot);
+    breakdownPlot->xAxis->setLabel("Time");
+    breakdownPlot->yAxis->setLabel("CPU time (%)");
+    breakdownPlot->yAxis2->setVisible(true);
+    breakdownPlot->yAxis2->setLabel("Frequency (MHz)");
+
+    QSharedPointer<QCPAxisTickerDateTime> dateTimeTicker(new QCPAxisTickerDateTime);
+    dateTimeTicker->setDateTimeFormat("HH.mm");
+    dateTimeTicker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    dateTimeTicker->setTickCount(6);
+    breakdownPlot->xAxis->setTicker(dateTimeTicker);
+    breakdownPlot->yAxis->setRange(0, 100);
+
+    breakdownPlot->setBackground(QColor(240, 240, 240));
+    breakdownPlot->xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    breakdownPlot->yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+
+    // Накопление: каждый канал заливается до верхней границы предыдущего
+    const QColor colors[MetricChannels::BREAKDOWN_COUNT] = {
+        QColor(30, 90, 180),   // user
+        QColor(220, 50, 50),   // sys
+        QColor(255, 150, 0),   // iowait
+        QColor(128, 0, 128),   // steal
+        QColor(0, 150, 60)     // irq
+    };
+    for (int k = 0; k < MetricChannels::BREAKDOWN_COUNT; ++k) {
+        QCPGraph *graph = breakdownPlot->addGraph();
+        graph->setName(MetricChannels::name(static_cast<MetricChannel>(k)));
+        graph->setPen(QPen(colors[k], 1));
+        QColor fill = colors[k];
+        fill.setAlpha(110);
+        graph->setBrush(fill);
+        if (k > 0) {
+            graph->setChannelFillGraph(breakdownGraphs.last());
+        }
+        breakdownGraphs.append(graph);
+    }
+
+    frequencyGraph = breakdownPlot->addGraph(breakdownPlot->xAxis, breakdownPlot->yAxis2);
+    frequencyGraph->setName(MetricChannels::name(MetricChannel::Frequency));
+    frequencyGraph->setPen(QPen(Qt::black, 1, Qt::DashLine));
+
+    breakdownPlot->legend->setVisible(true);
+    breakdownPlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
+
+    connect(breakdownSeriesBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::refreshBreakdownPlot);
+}
+
+void MainWindow::refreshBreakdownPlot()
+{
+    const HostModel *host = displayedHost();
+    if (!isBreakdownVisible() || !host || host->history.isEmpty()) {
+        return;
+    }
+    TRACE_SCOPE("MainWindow::refreshBreakdownPlot");
+    const CpuHistory &history = host->history;
+
+    // Список рядов следует за набором ядер отображаемого хоста
+    if (breakdownSeriesBox->count() != history.coreCount() + 1) {
+        const QSignalBlocker blocker(breakdownSeriesBox);
+        const int current = breakdownSeriesBox->currentIndex();
+        breakdownSeriesBox->clear();
+        breakdownSeriesBox->addItem("All cores (mean)");
+        for (int core = 0; core < history.coreCount(); ++core) {
+            breakdownSeriesBox->addItem(QString("Core %1").arg(core));
+        }
+        breakdownSeriesBox->setCurrentIndex(qBound(0, current, breakdownSeriesBox->count() - 1));
+    }
+    const int core = breakdownSeriesBox->currentIndex() - 1;  // -1 — среднее по ядрам
+    auto copyChannel = [&](MetricChannel channel, QVector<double> &values) {
+        if (!history.hasChannel(channel)) {
+            values.fill(std::nan(""), history.size());
+        } else if (core < 0) {
+            history.copyChannelMean(channel, values);
         } else {
-            qCDebug(cpuMonitor) << "Failed to parse line:" << line;
+            history.copyChannel(channel, core, values);
+        }
+    };
+
+    bool anyChannel = false;
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        anyChannel = anyChannel || history.hasChannel(static_cast<MetricChannel>(c));
+    }
+    if (!anyChannel) {
+        // Не оставляем на графике ряды предыдущего хоста
+        for (QCPGraph *graph : breakdownGraphs) {
+            graph->data()->clear();
         }
+        frequencyGraph->data()->clear();
+        breakdownLabel->setText("No channel breakdown reported by this host");
+        breakdownPlot->replot();
+        return;
     }
 
-    updatePlots(currentUsages);
+    history.copyTimes(graphKeys);
+    for (int k = 0; k < MetricChannels::BREAKDOWN_COUNT; ++k) {
+        copyChannel(static_cast<MetricChannel>(k), breakdownStack[k]);
+    }
+    // Накопленные суммы по строкам; не переданный в строке канал считается нулем,
+    // а строка без единого канала остается разрывом
+    double yMax = 0.0;
+    for (int row = 0; row < graphKeys.size(); ++row) {
+        bool any = false;
+        for (int k = 0; k < MetricChannels::BREAKDOWN_COUNT; ++k) {
+            any = any || !std::isnan(breakdownStack[k][row]);
+        }
+        double sum = 0.0;
+        for (int k = 0; k < MetricChannels::BREAKDOWN_COUNT; ++k) {
+            const double value = breakdownStack[k][row];
+            sum += std::isnan(value) ? 0.0 : value;
+            breakdownStack[k][row] = any ? sum : std::nan("");
+        }
+        if (any) {
+            yMax = qMax(yMax, sum);
+        }
+    }
+    for (int k = 0; k < MetricChannels::BREAKDOWN_COUNT; ++k) {
+        breakdownGraphs[k]->setData(graphKeys, breakdownStack[k], true);
+    }
+
+    copyChannel(MetricChannel::Frequency, graphValues);
+    frequencyGraph->setData(graphKeys, graphValues, true);
+    double frequencyMax = 0.0;
+    for (double value : graphValues) {
+        frequencyMax = qMax(frequencyMax, value);
+    }
+    breakdownPlot->yAxis2->setRange(0, qMax(1000.0, std::ceil(frequencyMax * Y_AXIS_MARGIN_FACTOR / 500.0) * 500.0));
+
+    const double windowEnd = replayMode ? std::ceil(history.lastTime()) : currentTimeSec;
+    breakdownPlot->xAxis->setRange(windowEnd - X_VISIBLE_MINUTES * 60, windowEnd);
+    breakdownPlot->yAxis->setRange(0, qMax(MIN_Y_AXIS_RANGE, roundToTen(yMax * Y_AXIS_MARGIN_FACTOR)));
+
+    // Последний сэмпл по каждому переданному каналу
+    QStringList parts;
+    const int last = history.size() - 1;
+    for (int c = 0; c < MetricChannels::COUNT; ++c) {
+        const MetricChannel channel = static_cast<MetricChannel>(c);
+        if (!history.hasChannel(channel)) {
+            continue;
+        }
+        const double value = core < 0 ? history.channelMeanAt(channel, last) : history.channelAt(channel, core, last);
+        if (!std::isnan(value)) {
+            parts.append(QString("%1 %2 %3").arg(MetricChannels::name(channel))
+                             .arg(value, 0, 'f', channel == MetricChannel::Frequency ? 0 : 1)
+                             .arg(MetricChannels::unit(channel)));
+        }
+    }
+    breakdownLabel->setText(parts.join("  "));
+
+    breakdownPlot->replot();
 }
 
-void MainWindow::updatePlots(const QVector<double> &cpuUsages)
+bool MainWindow::isPercentileVisible() const
 {
-    int coreCount = cpuUsages.size();
-    if (coreCount == 0 || cpuGraphs.size() != coreCount) {
-        qCWarning(cpuMonitor) << "Core count mismatch:" << coreCount << "vs" << cpuGraphs.size();
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == percentileTab;
+}
+
+void MainWindow::setupPercentileTab()
+{
+    percentileTab = new QWidget(this);
+    QVBoxLayout *layout = new QVBoxLayout(percentileTab);
+    layout->setContentsMargins(0, 0, 0, 0);
+
+    QHBoxLayout *controls = new QHBoxLayout();
+    controls->setContentsMargins(8, 6, 8, 0);
+    percentileSeriesBox = new QComboBox(percentileTab);
+    percentileTierBox = new QComboBox(percentileTab);
+    percentileTierBox->addItem("Last hour, 1 min windows");
+    percentileTierBox->addItem("Last day, 1 h windows");
+    percentileSummaryLabel = new QLabel(percentileTab);
+    controls->addWidget(percentileSeriesBox);
+    controls->addWidget(percentileTierBox);
+    controls->addWidget(percentileSummaryLabel, 1);
+    layout->addLayout(controls);
+
+    percentilePlot = new QCustomPlot(percentileTab);
+    layout->addWidget(percentilePlot);
+    percentilePlot->xAxis->setLabel("Time");
+    percentilePlot->yAxis->setLabel("CPU Usage (%)");
+    percentilePlot->xAxis->setTicker(QSharedPointer<QCPAxisTickerDateTime>(new QCPAxisTickerDateTime));
+    percentilePlot->setBackground(QColor(240, 240, 240));
+    percentilePlot->xAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+    percentilePlot->yAxis->grid()->setPen(QPen(QColor(180, 180, 180), 1));
+
+    // Полосы: p50..p95 — темнее, p95..p99 — светлее
+    percentileP50Graph = percentilePlot->addGraph();
+    percentileP50Graph->setName("p50");
+    percentileP50Graph->setPen(QPen(QColor(30, 90, 180), 2));
+
+    percentileP95Graph = percentilePlot->addGraph();
+    percentileP95Graph->setName("p95");
+    percentileP95Graph->setPen(QPen(QColor(30, 90, 180, 160), 1));
+    percentileP95Graph->setBrush(QColor(30, 90, 180, 90));
+    percentileP95Graph->setChannelFillGraph(percentileP50Graph);
+
+    percentileP99Graph = percentilePlot->addGraph();
+    percentileP99Graph->setName("p99");
+    percentileP99Graph->setPen(QPen(QColor(30, 90, 180, 100), 1));
+    percentileP99Graph->setBrush(QColor(30, 90, 180, 40));
+    percentileP99Graph->setChannelFillGraph(percentileP95Graph);
+
+    percentilePlot->legend->setVisible(true);
+    percentilePlot->axisRect()->insetLayout()->setInsetAlignment(0, Qt::AlignTop | Qt::AlignLeft);
+
+    connect(percentileSeriesBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::refreshPercentilePlot);
+    connect(percentileTierBox, QOverload<int>::of(&QComboBox::currentIndexChanged),
+            this, &MainWindow::refreshPercentilePlot);
+}
+
+void MainWindow::refreshPercentilePlot()
+{
+    const HostModel *host = displayedHost();
+    if (!isPercentileVisible() || !host || host->rollup.isEmpty()) {
         return;
     }
+    TRACE_SCOPE("MainWindow::refreshPercentilePlot");
+    const SketchRollup &rollup = host->rollup;
+
+    // Список рядов следует за набором ядер отображаемого хоста
+    if (percentileSeriesBox->count() != rollup.seriesCount()) {
+        const QSignalBlocker blocker(percentileSeriesBox);
+        const int current = percentileSeriesBox->currentIndex();
+        percentileSeriesBox->clear();
+        percentileSeriesBox->addItem("Total");
+        for (int core = 0; core + 1 < rollup.seriesCount(); ++core) {
+            percentileSeriesBox->addItem(QString("Core %1").arg(core));
+        }
+        percentileSeriesBox->setCurrentIndex(qBound(0, current, percentileSeriesBox->count() - 1));
+    }
+    const int seriesIndex = percentileSeriesBox->currentIndex();
+    const SketchRollup::Tier tier = percentileTierBox->currentIndex() == 0 ? SketchRollup::Tier::Minute
+                                                                           : SketchRollup::Tier::Hour;
+
+    rollup.copyQuantiles(seriesIndex, tier, percentileTimes, percentileP50, percentileP95, percentileP99);
+    percentileP50Graph->setData(percentileTimes, percentileP50, true);
+    percentileP95Graph->setData(percentileTimes, percentileP95, true);
+    percentileP99Graph->setData(percentileTimes, percentileP99, true);
+
+    const double windowSec = SketchRollup::windowSeconds(tier);
+    const double span = tier == SketchRollup::Tier::Minute ? 3600.0 : 86400.0;
+    const double end = percentileTimes.isEmpty() ? currentTimeSec : percentileTimes.last() + windowSec / 2.0;
+    qSharedPointerCast<QCPAxisTickerDateTime>(percentilePlot->xAxis->ticker())
+        ->setDateTimeFormat(tier == SketchRollup::Tier::Minute ? "HH.mm" : "dd.MM HH.mm");
+    percentilePlot->xAxis->setRange(end - span, end);
 
-    double totalUsage = calculateTotalCpuUsage(cpuUsages);
-    currentTimeSec = QDateTime::currentSecsSinceEpoch();
+    double yMax = 0.0;
+    for (double value : percentileP99) {
+        yMax = qMax(yMax, value);
+    }
+    percentilePlot->yAxis->setRange(0, qMax(MIN_Y_AXIS_RANGE, roundToTen(yMax * Y_AXIS_MARGIN_FACTOR)));
+
+    // Квантили за весь интервал — слиянием готовых эскизов окон
+    const UsageSketch merged = rollup.query(seriesIndex, end - span, end);
+    if (!merged.isEmpty()) {
+        percentileSummaryLabel->setText(QString("%1: p50 %2%  p95 %3%  p99 %4%  max %5%")
+                                            .arg(tier == SketchRollup::Tier::Minute ? "Last hour" : "Last day")
+                                            .arg(merged.quantile(0.50), 0, 'f', 1)
+                                            .arg(merged.quantile(0.95), 0, 'f', 1)
+                                            .arg(merged.quantile(0.99), 0, 'f', 1)
+                                            .arg(merged.max(), 0, 'f', 1));
+    }
+
+    percentilePlot->replot();
+}
+
+void MainWindow::setupAlerts()
+{
+    alertEngine = new AlertEngine(this);
+    alertEngine->setRules(AlertEngine::defaultRules());
+    connect(alertEngine, &AlertEngine::alertChanged, this, &MainWindow::onAlertChanged);
+
+    alertTable = new QTableWidget(0, 5, this);
+    alertTable->setHorizontalHeaderLabels({"Time", "State", "Host", "Rule", "Value"});
+    alertTable->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    alertTable->horizontalHeader()->setSectionResizeMode(3, QHeaderView::Stretch);
+    alertTable->setEditTriggers(QTableWidget::NoEditTriggers);
+    alertTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    alertTable->verticalHeader()->setVisible(false);
+
+    alertLabel = new QLabel(this);
+    statusBar()->addPermanentWidget(alertLabel);
+
+    // Молчащие хосты проверяются раз в секунду
+    QTimer *missingTimer = new QTimer(this);
+    connect(missingTimer, &QTimer::timeout, this, [this]() {
+        // При воспроизведении «сейчас» — время последней записанной датаграммы
+        const qint64 nowMs = replayMode ? lastReceiveTimeMs : QDateTime::currentMSecsSinceEpoch();
+        if (nowMs > 0) {
+            alertEngine->checkMissing(nowMs / 1000.0);
+        }
+    });
+    missingTimer->start(ALERT_CHECK_MS);
+}
+
+void MainWindow::updateAlertStatus()
+{
+    const int activeCount = alertEngine->activeCount();
+    alertLabel->setText(QString("Alerts: %1").arg(activeCount));
+    alertLabel->setStyleSheet(activeCount > 0 ? "color: #cc0000; font-weight: bold;" : QString());
+    tabWidget->tabBar()->setTabTextColor(tabWidget->indexOf(alertTable),
+                                         activeCount > 0 ? QColor(204, 0, 0) : palette().text().color());
+}
+
+void MainWindow::onAlertChanged(const AlertEvent &event)
+{
+    updateAlertStatus();
+    if (alertLog.isOpen()) {
+        // Одно предупреждение на серию неудачных записей, а не на каждое событие
+        const bool written = alertLog.write(event);
+        if (!written && !alertLogFailing) {
+            qCWarning(cpuMonitor) << "Failed to write alert log:" << alertLog.errorString();
+        }
+        alertLogFailing = !written;
+    }
+
+    // Новые события сверху; таблица ограничена, чтобы шторм оповещений не рос без предела
+    const bool firing = event.state == AlertEvent::State::Firing;
+    const QString host = event.core >= 0 ? QString("%1 core %2").arg(event.hostId).arg(event.core) : event.hostId;
+    alertTable->insertRow(0);
+    alertTable->setItem(0, 0, new QTableWidgetItem(
+                                  QDateTime::fromMSecsSinceEpoch(static_cast<qint64>(event.timeSec * 1000.0))
+                                      .toString("HH:mm:ss")));
+    alertTable->setItem(0, 1, new QTableWidgetItem(firing ? "FIRING" : "resolved"));
+    alertTable->setItem(0, 2, new QTableWidgetItem(host));
+    alertTable->setItem(0, 3, new QTableWidgetItem(event.rule));
+    alertTable->setItem(0, 4, new QTableWidgetItem(event.valueText()));
+    if (firing) {
+        alertTable->item(0, 1)->setForeground(QColor(204, 0, 0));
+    }
+    if (alertTable->rowCount() > MAX_ALERT_ROWS) {
+        alertTable->setRowCount(MAX_ALERT_ROWS);
+    }
+}
+
+bool MainWindow::isSparklinesVisible() const
+{
+    return isVisible() && !isMinimized() && tabWidget->currentWidget() == sparklineGrid;
+}
+
+void MainWindow::advanceSparklines()
+{
+    const HostModel *host = displayedHost();
+    if (host && !host->history.isEmpty()) {
+        sparklineGrid->advance(host->history, std::ceil(host->history.lastTime()));
+    }
+}
+
+void MainWindow::catchUpVisibleViews()
+{
+    const HostModel *host = displayedHost();
+    if (!host || host->history.isEmpty()) {
+        return;
+    }
+
+    if (tableDirty && isTableVisible()) {
+        // Значения последнего сэмпла берем из истории
+        const CpuHistory &history = host->history;
+        QVector<double> lastUsages(history.coreCount());
+        for (int i = 0; i < history.coreCount(); ++i) {
+            lastUsages[i] = history.coreAt(i, history.size() - 1);
+        }
+        updateCoreBars(lastUsages);
+        tableDirty = false;
+    }
+
+    if (plotDirty && isPlotVisible()) {
+        updatePlots();
+    }
+
+    // Сетка сама пересчитывает столбцы, если пропущено слишком много строк
+    if (isSparklinesVisible()) {
+        advanceSparklines();
+    }
+    refreshFleet();
+    refreshClusterPlot();
+    refreshPercentilePlot();
+    refreshImbalancePlot();
+    refreshTopologyView();
+    refreshBreakdownPlot();
+}
+
+void MainWindow::changeEvent(QEvent *event)
+{
+    QMainWindow::changeEvent(event);
+    if (event->type() == QEvent::WindowStateChange && !isMinimized()) {
+        catchUpVisibleViews();
+    }
+}
+
+void MainWindow::showEvent(QShowEvent *event)
+{
+    QMainWindow::showEvent(event);
+    catchUpVisibleViews();
+}
+
+void MainWindow::setForecastHorizon(double seconds)
+{
+    // Граница сверху держит число точек прогноза небольшим; сравнение отсекает и nan
+    forecastHorizonSec = seconds > 0.0 ? qMin(seconds, MAX_FORECAST_HORIZON_SEC) : 0.0;
+    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec + forecastExtentSec());
+    if (forecastHorizonSec == 0.0) {
+        forecastGraph->data()->clear();
+    }
+    plotDirty = true;
+}
+
+void MainWindow::setSmoothing(const DerivedSpec &spec)
+{
+    smoothing = spec;
+
+    // Элементы управления следуют за режимом, заданным и из командной строки
+    const QSignalBlocker boxBlocker(smoothingBox);
+    const QSignalBlocker windowBlocker(smoothingWindowBox);
+    smoothingBox->setCurrentIndex(smoothingBox->findData(static_cast<int>(spec.kind)));
+    // Точность и нижняя граница поля — до значения, иначе setValue округлит его
+    const bool ema = spec.kind == DerivedSpec::Kind::Ema;
+    smoothingWindowBox->setDecimals(ema ? 2 : 0);
+    smoothingWindowBox->setMinimum(ema ? DerivedSpec::HALF_LIFE_STEP_SEC : 1.0);
+    smoothingWindowBox->setSingleStep(ema ? 0.5 : 1.0);
+    if (spec.isActive()) {
+        smoothingWindowBox->setValue(spec.param);
+    }
+    smoothingWindowBox->setEnabled(spec.isActive());
+    smoothingWindowBox->setSuffix(ema ? " s half-life" : " samples");
+
+    // Производный ряд ведется только у отображаемого хоста; включение
+    // один раз пересчитывает его по истории, дальше он обновляется при приеме
+    if (HostModel *host = displayedHost()) {
+        host->history.setDerived(smoothing);
+        if (isPlotVisible()) {
+            refreshGraphData();
+            replotCustomPlot();
+        } else {
+            plotDirty = true;
+        }
+    }
+}
+
+void MainWindow::showHost(HostModel *host)
+{
+    qCInfo(cpuMonitor) << "Displaying host" << host->id;
+    if (HostModel *previous = displayedHost()) {
+        previous->history.setDerived(DerivedSpec());
+    }
+    displayedHostId = host->id;
+    host->history.setDerived(smoothing);
+
+    // Таблица и графики ядер строятся заново под набор ядер нового хоста
+    coresTable->setRowCount(0);
+    for (QCPGraph *graph : cpuGraphs) {
+        customPlot->removeGraph(graph);
+    }
+    cpuGraphs.clear();
+    stripChart->invalidate();
+    sparklineGrid->invalidate();
+
+    applyCoreSet();
+    setWindowTitle(QString("CPU Monitor: %1").arg(host->id));
+}
+
+void MainWindow::applyCoreSet()
+{
+    const HostModel *host = displayedHost();
+    if (!host) {
+        return;
+    }
+    const CpuHistory &history = host->history;
+    const int coreCount = history.coreCount();
+    qCInfo(cpuMonitor) << "Core set changed:" << history.onlineCoreCount() << "of" << coreCount << "online";
+
+    // Строки и графики только добавляются: у пропавших ядер сохраняется история
+    for (int i = coresTable->rowCount(); i < coreCount; ++i) {
+        coresTable->insertRow(i);
+
+        QTableWidgetItem *coreItem = new QTableWidgetItem();
+        coreItem->setTextAlignment(Qt::AlignCenter);
+        coresTable->setItem(i, 0, coreItem);
+
+        QProgressBar *bar = new QProgressBar();
+        bar->setRange(0, 100);
+        bar->setTextVisible(true);
+        bar->setFormat("%v%");
+        coresTable->setCellWidget(i, 1, bar);
+    }
+
+    while (cpuGraphs.size() < coreCount) {
+        QCPGraph *graph = customPlot->addGraph(customPlot->xAxis, customPlot->yAxis);
+        graph->setPen(corePen(cpuGraphs.size()));
+        graph->setVisible(true);
+        cpuGraphs.append(graph);
+    }
+    // Прогноз и отметки аномалий остаются поверх добавленных графиков ядер
+    forecastGraph->setLayer(dataLayer);
+    anomalyGraph->setLayer(dataLayer);
 
-    // Добавляем текущее время в историю
-    timeHistory.append(currentTimeSec);
-    if (timeHistory.size() > MAX_HISTORY_POINTS) {
-        timeHistory.remove(0);
+    QVector<QColor> stripColors;
+    stripColors.reserve(coreCount);
+    for (int i = 0; i < coreCount; ++i) {
+        stripColors.append(getColorForCore(i));
     }
+    stripChart->setCoreColors(stripColors);
 
-    // Обновляем данные ядер
     for (int i = 0; i < coreCount; ++i) {
-        cpuHistory[i].append(cpuUsages[i]);
-        if (cpuHistory[i].size() > MAX_HISTORY_POINTS) {
-            cpuHistory[i].remove(0);
+        const bool online = history.isCoreOnline(i);
+
+        if (QTableWidgetItem *coreItem = coresTable->item(i, 0)) {
+            coreItem->setText(online ? QString("Core %1").arg(i) : QString("Core %1 (offline)").arg(i));
+            coreItem->setForeground(online ? palette().text() : palette().placeholderText());
         }
 
-        QVector<double> keys;
-        int startIdx = qMax(0, timeHistory.size() - cpuHistory[i].size());
-        for (int j = startIdx; j < timeHistory.size(); ++j) {
-            keys.append(timeHistory[j]);
+        if (QProgressBar *bar = qobject_cast<QProgressBar*>(coresTable->cellWidget(i, 1))) {
+            bar->setEnabled(online);
+            if (!online) {
+                bar->setValue(0);
+                bar->setFormat("offline");
+            } else {
+                bar->setFormat("%v%");
+            }
         }
-        cpuGraphs[i]->setData(keys, cpuHistory[i]);
     }
+}
 
-    // Обновляем общую нагрузку
-    totalCpuHistory.append(totalUsage);
-    if (totalCpuHistory.size() > MAX_HISTORY_POINTS) {
-        totalCpuHistory.remove(0);
+void MainWindow::updatePacketStatsLabel()
+{
+    const SequenceStats total = ingest.sequenceStats();
+
+    packetStatsLabel->setText(QString("Packets: %1  Lost: %2 (%3%)  Duplicated: %4  Reordered: %5")
+                                  .arg(total.received)
+                                  .arg(total.lost)
+                                  .arg(total.lossRatio() * 100.0, 0, 'f', 2)
+                                  .arg(total.duplicated)
+                                  .arg(total.reordered)
+                              + QString("  Incomplete samples: %1").arg(ingest.incompleteSamples()));
+}
+
+void MainWindow::replotCustomPlot()
+{
+    if (plotMode == PlotMode::Threaded) {
+        submitOffscreenFrame();
+        return;
+    }
+    if (plotMode == PlotMode::StripChart) {
+        advanceStripChart();
+        return;
     }
 
-    QVector<double> totalKeys;
-    int startIdx = qMax(0, timeHistory.size() - totalCpuHistory.size());
-    for (int j = startIdx; j < timeHistory.size(); ++j) {
-        totalKeys.append(timeHistory[j]);
+    PerfCounters &counters = PerfCounters::global();
+    const qint64 startNs = PerfCounters::nowNs();
+
+    const QCPRange xRange = customPlot->xAxis->range();
+    const QCPRange yRange = customPlot->yAxis->range();
+    if (axesDrawn && xRange == drawnXRange && yRange == drawnYRange) {
+        TRACE_SCOPE("QCPLayer::replot(data)");
+        dataLayer->replot();
+        PerfCounters::add(counters.dataLayerReplots);
+    } else {
+        TRACE_SCOPE("QCustomPlot::replot");
+        customPlot->replot();
+        drawnXRange = xRange;
+        drawnYRange = yRange;
+        axesDrawn = true;
     }
-    totalGraph->setData(totalKeys, totalCpuHistory);
 
-    // === ОБНОВЛЯЕМ ИНДИКАТОР ===
-    totalCpuIndicator->updatePosition(totalUsage);
-    totalCpuIndicator->setText(QString::number(totalUsage, 'f', 1) + " %");
+    const qint64 elapsedNs = PerfCounters::nowNs() - startNs;
+    PerfCounters::add(counters.replotNsTotal, elapsedNs);
+    PerfCounters::add(counters.replotCount);
+
+    if (renderQuality.addFrame(elapsedNs / 1e6)) {
+        applyRenderQuality();
+    }
+}
+
+void MainWindow::setFrameBudget(double ms)
+{
+    renderQuality.setBudget(ms);
+}
+
+void MainWindow::applyRenderQuality()
+{
+    const RenderQuality::Level level = renderQuality.level();
+    qCInfo(cpuMonitor) << "Render quality:" << RenderQuality::levelName(level)
+                       << "average replot" << renderQuality.averageMs() << "ms";
+
+    const bool fast = level >= RenderQuality::Level::FastPolylines;
+    customPlot->setNotAntialiasedElements(fast ? QCP::aePlottables : QCP::aeNone);
+    customPlot->setPlottingHint(QCP::phFastPolylines, fast);
+
+    for (int i = 0; i < cpuGraphs.size(); ++i) {
+        cpuGraphs[i]->setPen(corePen(i));
+    }
+    totalGraph->setPen(totalPen());
+
+    // Прореживание задается при копировании данных в графики
+    refreshGraphData();
+    qualityLabel->setText(QString("Quality: %1").arg(RenderQuality::levelName(level)));
+}
+
+QPen MainWindow::corePen(int coreIndex) const
+{
+    // Перо толщиной 0 — косметическое в один пиксель, самое дешевое для растеризатора
+    const bool thin = renderQuality.level() >= RenderQuality::Level::ThinPens;
+    return QPen(getColorForCore(coreIndex), thin ? 0 : 1);
+}
+
+QPen MainWindow::totalPen() const
+{
+    const bool thin = renderQuality.level() >= RenderQuality::Level::ThinPens;
+    return QPen(QColor(0, 0, 0), thin ? 1 : 4);
+}
+
+void MainWindow::submitOffscreenFrame()
+{
+    TRACE_SCOPE("MainWindow::submitOffscreenFrame");
+
+    const HostModel *host = displayedHost();
+    if (!host || host->history.isEmpty()) {
+        return;
+    }
+    const CpuHistory &history = host->history;
+
+    // Диапазоны уже посчитаны для осей QCustomPlot, снимок их только копирует;
+    // в этом режиме ось X не продлевается на прогноз (forecastExtentSec)
+    PlotFrame frame;
+    frame.size = offscreenPlot->size();
+    frame.devicePixelRatio = offscreenPlot->devicePixelRatioF();
+    frame.xMin = customPlot->xAxis->range().lower;
+    frame.xMax = customPlot->xAxis->range().upper;
+    frame.yMax = customPlot->yAxis->range().upper;
+    frame.yTickStep = yAxisTickStep(frame.yMax);
+
+    history.copyTimes(frame.keys);
+    frame.cores.resize(history.coreCount());
+    frame.coreColors.reserve(history.coreCount());
+    for (int i = 0; i < history.coreCount(); ++i) {
+        if (history.hasDerived()) {
+            history.copyDerivedCore(i, frame.cores[i]);
+        } else {
+            history.copyCore(i, frame.cores[i]);
+        }
+        frame.coreColors.append(getColorForCore(i));
+    }
+    history.copyTotal(frame.total);
+
+    offscreenPlot->submit(frame);
+}
+
+void MainWindow::advanceStripChart()
+{
+    const HostModel *host = displayedHost();
+    if (!host || host->history.isEmpty()) {
+        return;
+    }
+
+    const double yMax = customPlot->yAxis->range().upper;
+    stripChart->setYAxis(yMax, yAxisTickStep(yMax));
+    stripChart->advance(host->history, currentTimeSec);
+}
+
+void MainWindow::setPlotMode(PlotMode mode)
+{
+    if (plotMode == mode) {
+        return;
+    }
+    plotMode = mode;
+    customPlot->setVisible(mode == PlotMode::Interactive);
+    offscreenPlot->setVisible(mode == PlotMode::Threaded);
+    stripChart->setVisible(mode == PlotMode::StripChart);
+
+    // Неактивные виджеты не обновлялись, перерисовываем с нуля
+    stripChart->invalidate();
+    plotDirty = true;
+    axesDrawn = false;
+    catchUpVisibleViews();
+    if (perfOverlayOn) {
+        updatePerfOverlay();
+    }
+}
+
+void MainWindow::setupPerfOverlay()
+{
+    // Оверлей на отдельном буферизованном слое: обновление текста
+    // перерисовывает только этот слой, а не весь график
+    customPlot->addLayer("perf", customPlot->layer("overlay"), QCustomPlot::limAbove);
+    QCPLayer *perfLayer = customPlot->layer("perf");
+    perfLayer->setMode(QCPLayer::lmBuffered);
+
+    perfOverlay = new QCPItemText(customPlot);
+    perfOverlay->setLayer(perfLayer);
+    perfOverlay->setClipToAxisRect(false);
+    perfOverlay->position->setType(QCPItemPosition::ptAxisRectRatio);
+    perfOverlay->position->setCoords(0.01, 0.02);
+    perfOverlay->setPositionAlignment(Qt::AlignLeft | Qt::AlignTop);
+    perfOverlay->setTextAlignment(Qt::AlignLeft);
+    perfOverlay->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    perfOverlay->setPadding(QMargins(6, 4, 6, 4));
+    perfOverlay->setPen(QPen(QColor(80, 80, 80)));
+    perfOverlay->setBrush(QBrush(QColor(255, 255, 255, 220)));
+    perfOverlay->setVisible(false);
+
+    // Фоновая отрисовка и самописец не показывают QCustomPlot, поэтому там
+    // те же значения выводятся в строку состояния
+    perfStatusLabel = new QLabel(this);
+    perfStatusLabel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    perfStatusLabel->setVisible(false);
+    statusBar()->addWidget(perfStatusLabel);
+
+    connect(perfOverlayTimer, &QTimer::timeout, this, &MainWindow::updatePerfOverlay);
+
+    // F12 — показать/скрыть оверлей производительности
+    QShortcut *toggle = new QShortcut(QKeySequence(Qt::Key_F12), this);
+    connect(toggle, &QShortcut::activated, this, &MainWindow::togglePerfOverlay);
+}
+
+void MainWindow::togglePerfOverlay()
+{
+    perfOverlayOn = !perfOverlayOn;
+    if (perfOverlayOn) {
+        lastPerfSnapshot = PerfSnapshot::take(PerfCounters::global());
+        updatePerfOverlay();
+        perfOverlayTimer->start(PERF_OVERLAY_INTERVAL_MS);
+    } else {
+        perfOverlayTimer->stop();
+        perfOverlay->setVisible(false);
+        perfStatusLabel->setVisible(false);
+        perfOverlay->layer()->replot();
+    }
+}
+
+void MainWindow::updatePerfOverlay()
+{
+    const PerfSnapshot now = PerfSnapshot::take(PerfCounters::global());
+    const PerfSnapshot &before = lastPerfSnapshot;
+    const double intervalSec = qMax<qint64>(1, now.takenNs - before.takenNs) / 1e9;
+
+    const quint64 ingestCount = now.ingestCount - before.ingestCount;
+    const quint64 latencyCount = now.latencyCount - before.latencyCount;
+    const double ingestUs = ingestCount ? (now.ingestNsTotal - before.ingestNsTotal) / 1e3 / ingestCount : 0.0;
+    const double latencyMs = latencyCount ? (now.latencyNsTotal - before.latencyNsTotal) / 1e6 / latencyCount : 0.0;
+    const quint64 replotCount = now.replotCount - before.replotCount;
+    const double replotMs = replotCount ? (now.replotNsTotal - before.replotNsTotal) / 1e6 / replotCount : 0.0;
+    const double dataOnlyPercent = replotCount ? 100.0 * (now.dataLayerReplots - before.dataLayerReplots) / replotCount : 0.0;
+    const SequenceStats sequence = ingest.sequenceStats();
+
+    const QString text = QString("Packets/s     %1\n"
+                                 "Ingest        %2 us\n"
+                                 "Latency       %3 ms\n"
+                                 "Replot (avg)  %4 ms  data-only %5%\n"
+                                 "Dropped       %6  lost %7\n"
+                                 "History       %8 MB  sketches %9 MB")
+                             .arg((now.datagramsReceived - before.datagramsReceived) / intervalSec, 0, 'f', 0)
+                             .arg(ingestUs, 0, 'f', 1)
+                             .arg(latencyMs, 0, 'f', 2)
+                             .arg(replotMs, 0, 'f', 2)
+                             .arg(dataOnlyPercent, 0, 'f', 0)
+                             .arg(now.datagramsDropped)
+                             .arg(sequence.lost)
+                             .arg(ingest.historyMemoryBytes() / (1024.0 * 1024.0), 0, 'f', 2)
+                             .arg(ingest.rollupMemoryBytes() / (1024.0 * 1024.0), 0, 'f', 2);
+
+    lastPerfSnapshot = now;
+    const bool onPlot = plotMode == PlotMode::Interactive;
+    perfStatusLabel->setVisible(!onPlot);
+    if (!onPlot) {
+        perfStatusLabel->setText(QString(text).replace('\n', " | ").simplified());
+    }
+    perfOverlay->setText(text);
+    perfOverlay->setVisible(onPlot);
+    if (isPlotVisible()) {
+        perfOverlay->layer()->replot();
+    }
+}
+
+void MainWindow::setTraceFile(const QString &path)
+{
+    traceFile = path;
+}
+
+void MainWindow::dumpTrace()
+{
+    QString error;
+    int events = Tracing::writeChromeTrace(traceFile, &error);
+    if (events < 0) {
+        statusBar()->showMessage(QString("Failed to write trace %1: %2").arg(traceFile, error), 5000);
+        return;
+    }
+    statusBar()->showMessage(QString("Wrote %1 trace events to %2").arg(events).arg(traceFile), 5000);
+}
+
+void MainWindow::updatePlots()
+{
+    TRACE_SCOPE("MainWindow::updatePlots");
+
+    const HostModel *host = displayedHost();
+    if (!host || host->history.isEmpty()) {
+        return;
+    }
+
+    // График не виден: данные уже в истории, перерисуем один раз при показе
+    if (!isPlotVisible()) {
+        plotDirty = true;
+        pendingLatencyStartNs = 0;
+        return;
+    }
+    plotDirty = false;
+
+    currentTimeSec = std::ceil(host->history.lastTime());
+    refreshGraphData();
 
     // Обновляем диапазон оси X
-    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec);
+    customPlot->xAxis->setRange(currentTimeSec - X_VISIBLE_MINUTES * 60, currentTimeSec + forecastExtentSec());
 
     updateYAxisRange();
-    customPlot->replot();
+    replotCustomPlot();
+
+    if (pendingLatencyStartNs != 0) {
+        PerfCounters &counters = PerfCounters::global();
+        PerfCounters::add(counters.latencyNsTotal, PerfCounters::nowNs() - pendingLatencyStartNs);
+        PerfCounters::add(counters.latencyCount);
+        pendingLatencyStartNs = 0;
+    }
 }
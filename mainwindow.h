@@ -10,57 +10,275 @@
 #include <QVector>
 #include <QColor>
 #include <QTimer>
+#include <QHash>
+#include <QTableView>
+#include <QComboBox>
+#include "alertengine.h"
+#include "alertlog.h"
 #include "axistag.h"
+#include "capturefile.h"
+#include "cpuingest.h"
+#include "fleetview.h"
+#include "perfcounters.h"
+#include "renderquality.h"
+#include "sparklinegrid.h"
+#include "plotrenderer.h"
+#include "stripchart.h"
+#include "replaysource.h"
 
 class QCustomPlot;
+class QDoubleSpinBox;
 class QCPGraph;
+class QCPItemText;
+class QCPLayer;
+class QTreeWidget;
+class QTreeWidgetItem;
 
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
+    // Глубина истории каждого хоста в точках; ей же ограничены окна сглаживания
+    static constexpr int MAX_HISTORY_POINTS = 300;
+    // Предельный горизонт прогноза общей загрузки
+    static constexpr double MAX_FORECAST_HORIZON_SEC = 600.0;
+
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Запись всех принятых датаграмм в файл
+    bool startCapture(const QString &path);
+    // Воспроизведение файла записи вместо приема по UDP; speed 0 — максимально быстро
+    bool startReplay(const QString &path, double speed);
+    // Файл для выгрузки трассировки по Ctrl+Shift+D
+    void setTraceFile(const QString &path);
+    // Способ отрисовки вкладки с графиком: QCustomPlot в GUI-потоке,
+    // фоновый поток или ленточный самописец
+    enum class PlotMode { Interactive, Threaded, StripChart };
+    void setPlotMode(PlotMode mode);
+    // Бюджет перерисовки, при превышении которого снижается качество
+    void setFrameBudget(double ms);
+    // Горизонт прогноза общей загрузки на графике; 0 — без прогноза
+    void setForecastHorizon(double seconds);
+    // Сглаживание линий ядер: EMA, скользящее среднее или максимум
+    void setSmoothing(const DerivedSpec &spec);
+    // Правила оповещений вместо правил по умолчанию
+    void setAlertRules(const QVector<AlertRule> &rules);
+    // Журнал событий оповещений (дописывается)
+    bool startAlertLog(const QString &path);
+
+signals:
+    void replayFinished(quint64 datagrams, qint64 elapsedMs);
+
+protected:
+    void changeEvent(QEvent *event) override;
+    void showEvent(QShowEvent *event) override;
+
 private slots:
     void onReadyRead();
     void updateXAxisRange();
+    void dumpTrace();
+    void togglePerfOverlay();
+    void catchUpVisibleViews();
+    void updatePerfOverlay();
+    void refreshFleet();
+    void selectFleetHost(const QModelIndex &index);
+    void onAlertChanged(const AlertEvent &event);
 
 private:
     void setupUI();
-    void parseAndDisplay(const QByteArray &data);
-    void updatePlots(const QVector<double> &cpuUsages);
+    void parseAndDisplay(const QByteArray &data, const QString &sender, qint64 receiveTimeMs);
+    void displaySample(const IngestResult &result);
+    void showHost(HostModel *host);
+    HostModel *displayedHost() const;
+    // На сколько секунд ось X продлевается за последний сэмпл ради прогноза
+    double forecastExtentSec() const;
+    void updatePlots();
+    void updateCoreBars(const QVector<double> &usages);
+    bool isPlotVisible() const;
+    bool isTableVisible() const;
+    bool isSparklinesVisible() const;
+    bool isFleetVisible() const;
+    bool isClusterVisible() const;
+    void setupClusterPlot();
+    void refreshClusterPlot();
+    bool isPercentileVisible() const;
+    void setupPercentileTab();
+    void refreshPercentilePlot();
+    bool isImbalanceVisible() const;
+    void setupImbalancePlot();
+    void refreshImbalancePlot();
+    bool isTopologyVisible() const;
+    void setupTopologyTab();
+    void rebuildTopologyView(const HostModel *host);
+    void refreshTopologyView();
+    bool isBreakdownVisible() const;
+    void setupBreakdownTab();
+    void refreshBreakdownPlot();
+    void setupAlerts();
+    void updateAlertStatus();
+    void advanceSparklines();
+    void replotCustomPlot();
+    void submitOffscreenFrame();
+    void advanceStripChart();
+    void applyRenderQuality();
+    QPen corePen(int coreIndex) const;
+    QPen totalPen() const;
+    void setupPerfOverlay();
+    void applyCoreSet();
+    void refreshGraphData();
+    void updatePacketStatsLabel();
     void updateYAxisRange();
-    QColor getColorForCore(int coreIndex);
-    double calculateTotalCpuUsage(const QVector<double> &cpuUsages);
+    QColor getColorForCore(int coreIndex) const;
     double roundToTen(double value);
+    static double yAxisTickStep(double yMax);
 
     static constexpr qint64 MAX_UDP_DATAGRAM_SIZE = 4096;
-    static constexpr int MAX_HISTORY_POINTS = 300;
     static constexpr int X_VISIBLE_MINUTES = 5;
     static constexpr int Y_AXIS_PADDING_FOR_TAG = 30;
     static constexpr double Y_AXIS_MARGIN_FACTOR = 1.1;
     static constexpr double MIN_Y_AXIS_RANGE = 10.0;
+    // Через сколько молчания отображаемого хоста переключаться на другой
+    static constexpr qint64 HOST_SWITCH_TIMEOUT_MS = 10000;
+    static constexpr int PERF_OVERLAY_INTERVAL_MS = 500;
+    static constexpr int FLEET_REFRESH_MS = 1000;
+    static constexpr int ALERT_CHECK_MS = 1000;
+    static constexpr int MAX_ALERT_ROWS = 500;
+    static constexpr double DEFAULT_FORECAST_HORIZON_SEC = 180.0;
+    static constexpr double FORECAST_STEP_SEC = 10.0;
 
     QUdpSocket *udpSocket;
     QTimer *updateTimer;
 
     QTabWidget *tabWidget;
+    QWidget *tableTab;
+    QWidget *plotTab;
+    SparklineGrid *sparklineGrid;
+    // Обзор парка; модель создается в setupUI поверх ingest.fleet()
+    QTableView *fleetTable = nullptr;
+    FleetModel *fleetModel = nullptr;
+    QTimer *fleetRefreshTimer = nullptr;
+    // Агрегаты по всем хостам: среднее, максимум и p95 общей загрузки
+    QCustomPlot *clusterPlot = nullptr;
+    QCPGraph *clusterMeanGraph = nullptr;
+    QCPGraph *clusterMaxGraph = nullptr;
+    QCPGraph *clusterP95Graph = nullptr;
+    QVector<double> clusterTimes;
+    QVector<double> clusterMean;
+    QVector<double> clusterMax;
+    QVector<double> clusterP95;
+    // Полосы p50/p95/p99 по окнам свертки отображаемого хоста
+    QWidget *percentileTab = nullptr;
+    QComboBox *percentileSeriesBox = nullptr;
+    QComboBox *percentileTierBox = nullptr;
+    QLabel *percentileSummaryLabel = nullptr;
+    QCustomPlot *percentilePlot = nullptr;
+    QCPGraph *percentileP50Graph = nullptr;
+    QCPGraph *percentileP95Graph = nullptr;
+    QCPGraph *percentileP99Graph = nullptr;
+    QVector<double> percentileTimes;
+    QVector<double> percentileP50;
+    QVector<double> percentileP95;
+    QVector<double> percentileP99;
+    // Неравномерность загрузки по ядрам отображаемого хоста
+    QWidget *imbalanceTab = nullptr;
+    QLabel *hotspotLabel = nullptr;
+    QCustomPlot *imbalancePlot = nullptr;
+    QCPGraph *imbalanceSpreadGraph = nullptr;
+    QCPGraph *imbalanceStdDevGraph = nullptr;
+    QCPGraph *imbalanceGiniGraph = nullptr;
+    // Группировка ядер отображаемого хоста по сокетам, NUMA-узлам и физическим ядрам
+    QWidget *topologyTab = nullptr;
+    QLabel *topologyLabel = nullptr;
+    QTreeWidget *topologyTree = nullptr;
+    QCustomPlot *topologyPlot = nullptr;
+    QVector<QCPGraph*> topologyGraphs;  // по графику на NUMA-узел
+    QVector<QTreeWidgetItem*> topologyItems[TopologyMap::LEVEL_COUNT];
+    QVector<QTreeWidgetItem*> topologyCoreItems;
+    // Для какого хоста и какой версии карты построены дерево и графики
+    QString topologyHostId;
+    quint32 topologyRevision = 0;
+    QVector<double> topologyUsages;
+    QVector<double> topologyValues;
+    QVector<int> topologyCounts;
+    // Разбивка времени CPU по каналам (user, sys, ...) с накоплением и частота
+    QWidget *breakdownTab = nullptr;
+    QComboBox *breakdownSeriesBox = nullptr;
+    QLabel *breakdownLabel = nullptr;
+    QCustomPlot *breakdownPlot = nullptr;
+    QVector<QCPGraph*> breakdownGraphs;  // по графику на канал разбивки
+    QCPGraph *frequencyGraph = nullptr;
+    QVector<double> breakdownStack[MetricChannels::BREAKDOWN_COUNT];
+    // Оповещения: правила проверяются на каждом сэмпле, события — в таблицу и журнал
+    AlertEngine *alertEngine = nullptr;
+    AlertLog alertLog;
+    // Ошибка записи журнала уже выведена; сбрасывается после успешной записи
+    bool alertLogFailing = false;
+    QTableWidget *alertTable = nullptr;
+    QLabel *alertLabel = nullptr;
     QLabel *totalLabel;
+    QLabel *packetStatsLabel;
     QTableWidget *coresTable;
 
     QCustomPlot *customPlot;
     QVector<QCPGraph*> cpuGraphs;
     QCPGraph *totalGraph;
+    QCPGraph *anomalyGraph = nullptr;
+    QCPGraph *forecastGraph = nullptr;
+    double forecastHorizonSec = DEFAULT_FORECAST_HORIZON_SEC;
+    QComboBox *smoothingBox = nullptr;
+    QDoubleSpinBox *smoothingWindowBox = nullptr;
+    DerivedSpec smoothing;
+    QVector<AnomalyMark> anomalyMarks;
     AxisTag *totalCpuIndicator;
+    OffscreenPlotWidget *offscreenPlot;
+    StripChartWidget *stripChart;
+    // Слой с графиками; диапазоны осей на момент последней полной перерисовки
+    QCPLayer *dataLayer = nullptr;
+    QCPRange drawnXRange;
+    QCPRange drawnYRange;
+    bool axesDrawn = false;
+    PlotMode plotMode = PlotMode::Interactive;
+    // Адаптивное качество по измеренному времени перерисовки
+    RenderQuality renderQuality;
+    QLabel *qualityLabel = nullptr;
+
+    // Оверлей производительности (F12): поверх QCustomPlot, а в режимах без него —
+    // одной строкой в строке состояния
+    QCPItemText *perfOverlay;
+    QLabel *perfStatusLabel = nullptr;
+    bool perfOverlayOn = false;
+    QTimer *perfOverlayTimer;
+    PerfSnapshot lastPerfSnapshot;
+    // Монотонное время приема текущей датаграммы и самого раннего не нарисованного сэмпла
+    qint64 currentReceiveNs = 0;
+    qint64 pendingLatencyStartNs = 0;
 
-    QVector<QVector<double>> cpuHistory;
-    QVector<double> totalCpuHistory;
-    QVector<double> timeHistory;
+    // Прием и история по хостам; на вкладках отображается один хост
+    CpuIngest ingest;
+    QString displayedHostId;
+    // Буферы для QCPGraph::setData, переиспользуемые между перерисовками
+    QVector<double> graphKeys;
+    QVector<double> graphValues;
+    // Начала групп прореживания для уровня RenderQuality::Level::Decimated
+    QVector<int> decimationStarts;
 
     double currentTimeSec;
 
+    CaptureWriter captureWriter;
+    ReplaySource *replaySource;
+    bool replayMode = false;
+
+    QString traceFile;
+
+    // Вкладка была скрыта, пока приходили данные, — перестроить при показе
+    bool tableDirty = false;
+    // Строка статистики пересчитывается по всем хостам, поэтому обновляется раз в секунду
+    bool packetStatsDirty = false;
+    qint64 lastReceiveTimeMs = 0;
+    bool plotDirty = false;
+
     // Выносим цвета по умолчанию в приватный метод
     QVector<QColor> getDefaultCoreColors() const;
 };
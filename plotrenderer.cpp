@@ -0,0 +1,210 @@
+#include "plotrenderer.h"
+#include "perfcounters.h"
+#include "tracing.h"
+#include <QPainter>
+#include <QPolygonF>
+#include <QResizeEvent>
+#include <cmath>
+
+namespace {
+
+// Поля области графика: слева подписи оси Y, снизу — времени
+constexpr int MARGIN_LEFT = 48;
+constexpr int MARGIN_RIGHT = 56;
+constexpr int MARGIN_TOP = 10;
+constexpr int MARGIN_BOTTOM = 28;
+
+} // namespace
+
+PlotRenderer::PlotRenderer(QObject *parent)
+    : QObject(parent)
+    , timeTicker(new QCPAxisTickerDateTime)
+    , valueTicker(new QCPAxisTickerFixed)
+{
+    // Как у осей customPlot в MainWindow::setupUI и MainWindow::updateYAxisRange
+    timeTicker->setDateTimeFormat("HH.mm");
+    timeTicker->setTickStepStrategy(QCPAxisTicker::tssMeetTickCount);
+    timeTicker->setTickCount(6);
+    valueTicker->setScaleStrategy(QCPAxisTickerFixed::ssMultiples);
+}
+
+void PlotRenderer::render(const PlotFrame &frame)
+{
+    TRACE_SCOPE("PlotRenderer::render");
+    const qint64 startNs = PerfCounters::nowNs();
+
+    QImage image(frame.size * frame.devicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    image.setDevicePixelRatio(frame.devicePixelRatio);
+    image.fill(QColor(240, 240, 240));
+
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+
+    const QRectF area(MARGIN_LEFT, MARGIN_TOP,
+                      frame.size.width() - MARGIN_LEFT - MARGIN_RIGHT,
+                      frame.size.height() - MARGIN_TOP - MARGIN_BOTTOM);
+    if (area.width() <= 0 || area.height() <= 0 || frame.xMax <= frame.xMin || frame.yMax <= 0) {
+        painter.end();
+        emit frameRendered(image, PerfCounters::nowNs() - startNs);
+        return;
+    }
+
+    // Сетка и подписи оси Y; формат чисел — как у QCPAxis по умолчанию
+    const QPen gridPen(QColor(180, 180, 180), 1);
+    const QFontMetrics metrics = painter.fontMetrics();
+    valueTicker->setTickStep(frame.yTickStep);
+    valueTicker->generate(QCPRange(0.0, frame.yMax), QLocale(), QLatin1Char('g'), 6,
+                          ticks, nullptr, &tickLabels);
+    for (int i = 0; i < ticks.size(); ++i) {
+        // generate оставляет по делению за краями диапазона
+        if (ticks[i] < 0.0 || ticks[i] > frame.yMax) {
+            continue;
+        }
+        const qreal py = area.bottom() - ticks[i] / frame.yMax * area.height();
+        painter.setPen(gridPen);
+        painter.drawLine(QPointF(area.left(), py), QPointF(area.right(), py));
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(0, py - metrics.height() / 2.0, MARGIN_LEFT - 4, metrics.height()),
+                         Qt::AlignRight | Qt::AlignVCenter, tickLabels[i]);
+    }
+
+    // Сетка и подписи оси времени
+    timeTicker->generate(QCPRange(frame.xMin, frame.xMax), QLocale(), QLatin1Char('g'), 6,
+                         ticks, nullptr, &tickLabels);
+    for (int i = 0; i < ticks.size(); ++i) {
+        if (ticks[i] < frame.xMin || ticks[i] > frame.xMax) {
+            continue;
+        }
+        const qreal px = area.left() + (ticks[i] - frame.xMin) / (frame.xMax - frame.xMin) * area.width();
+        painter.setPen(gridPen);
+        painter.drawLine(QPointF(px, area.top()), QPointF(px, area.bottom()));
+        painter.setPen(Qt::black);
+        painter.drawText(QRectF(px - 40, area.bottom() + 4, 80, metrics.height()), Qt::AlignHCenter,
+                         tickLabels[i]);
+    }
+
+    painter.setPen(Qt::black);
+    painter.setBrush(Qt::NoBrush);
+    painter.drawRect(area);
+
+    painter.save();
+    painter.setClipRect(area);
+    for (int i = 0; i < frame.cores.size(); ++i) {
+        painter.setPen(QPen(frame.coreColors.value(i, Qt::gray), 1));
+        drawSeries(painter, frame, area, frame.cores[i]);
+    }
+    painter.setPen(QPen(QColor(0, 0, 0), 4));
+    drawSeries(painter, frame, area, frame.total);
+    painter.restore();
+
+    // Метка текущей общей загрузки у правого края
+    if (!frame.total.isEmpty() && !std::isnan(frame.total.last())) {
+        const double value = frame.total.last();
+        const qreal py = area.bottom() - qBound(0.0, value / frame.yMax, 1.0) * area.height();
+        const QRectF tag(area.right() + 6, py - metrics.height() / 2.0 - 2,
+                         MARGIN_RIGHT - 8, metrics.height() + 4);
+        painter.setPen(QPen(QColor(0, 0, 0), 2));
+        painter.setBrush(Qt::white);
+        painter.drawRect(tag);
+        painter.drawText(tag, Qt::AlignCenter, QString::number(value, 'f', 1) + " %");
+    }
+
+    painter.end();
+    emit frameRendered(image, PerfCounters::nowNs() - startNs);
+}
+
+void PlotRenderer::drawSeries(QPainter &painter, const PlotFrame &frame, const QRectF &area,
+                              const QVector<double> &values)
+{
+    const int n = qMin(frame.keys.size(), values.size());
+    const double xScale = area.width() / (frame.xMax - frame.xMin);
+    const double yScale = area.height() / frame.yMax;
+
+    // NaN разрывает линию, как у QCPGraph
+    QPolygonF segment;
+    segment.reserve(n);
+    for (int i = 0; i < n; ++i) {
+        const double value = values[i];
+        if (std::isnan(value)) {
+            if (segment.size() > 1) {
+                painter.drawPolyline(segment);
+            }
+            segment.clear();
+            continue;
+        }
+        segment.append(QPointF(area.left() + (frame.keys[i] - frame.xMin) * xScale,
+                               area.bottom() - value * yScale));
+    }
+    if (segment.size() > 1) {
+        painter.drawPolyline(segment);
+    }
+}
+
+OffscreenPlotWidget::OffscreenPlotWidget(QWidget *parent)
+    : QWidget(parent)
+    , renderer(new PlotRenderer)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+
+    renderer->moveToThread(&renderThread);
+    connect(&renderThread, &QThread::finished, renderer, &QObject::deleteLater);
+    connect(renderer, &PlotRenderer::frameRendered, this, &OffscreenPlotWidget::onFrameRendered);
+    renderThread.setObjectName("plot-render");
+    renderThread.start();
+}
+
+OffscreenPlotWidget::~OffscreenPlotWidget()
+{
+    renderThread.quit();
+    renderThread.wait();
+}
+
+void OffscreenPlotWidget::submit(const PlotFrame &frame)
+{
+    // Кадры не копятся в очереди: устаревший ожидающий кадр заменяется новым
+    if (busy) {
+        pendingFrame = frame;
+        hasPending = true;
+        return;
+    }
+    dispatch(frame);
+}
+
+void OffscreenPlotWidget::dispatch(const PlotFrame &frame)
+{
+    busy = true;
+    PlotRenderer *target = renderer;
+    QMetaObject::invokeMethod(target, [target, frame]() { target->render(frame); }, Qt::QueuedConnection);
+}
+
+void OffscreenPlotWidget::onFrameRendered(const QImage &image, qint64 renderNs)
+{
+    busy = false;
+    lastFrame = image;
+    lastRenderNs = renderNs;
+    update();
+
+    if (hasPending) {
+        hasPending = false;
+        dispatch(pendingFrame);
+        pendingFrame = PlotFrame();
+    }
+}
+
+void OffscreenPlotWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    if (lastFrame.isNull()) {
+        painter.fillRect(rect(), QColor(240, 240, 240));
+        return;
+    }
+    // Во время изменения размера растягиваем старый кадр до прихода нового
+    painter.drawImage(rect(), lastFrame);
+}
+
+void OffscreenPlotWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    emit frameRequested();
+}
@@ -0,0 +1,92 @@
+#ifndef PLOTRENDERER_H
+#define PLOTRENDERER_H
+
+#include <QColor>
+#include <QImage>
+#include <QObject>
+#include <QThread>
+#include <QVector>
+#include <QWidget>
+#include "qcustomplot.h"
+
+// Неизменяемый снимок данных одного кадра. Рабочий поток читает только его
+// и не обращается ни к истории, ни к виджетам GUI-потока.
+struct PlotFrame
+{
+    QSize size;
+    qreal devicePixelRatio = 1.0;
+    double xMin = 0.0;
+    double xMax = 0.0;
+    double yMax = 100.0;
+    double yTickStep = 10.0;      // минимальный шаг QCPAxisTickerFixed оси Y
+    QVector<double> keys;
+    QVector<QVector<double>> cores;   // NaN — разрыв линии
+    QVector<QColor> coreColors;
+    QVector<double> total;
+};
+
+// Рисует кадр в QImage обычным QPainter; живет в рабочем потоке.
+// Деления осей считают те же ticker'ы QCustomPlot с теми же настройками,
+// что и у основного графика, поэтому сетка в обоих режимах совпадает.
+class PlotRenderer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PlotRenderer(QObject *parent = nullptr);
+
+    void render(const PlotFrame &frame);
+
+signals:
+    void frameRendered(const QImage &image, qint64 renderNs);
+
+private:
+    static void drawSeries(QPainter &painter, const PlotFrame &frame, const QRectF &area,
+                           const QVector<double> &values);
+
+    // Используются только в рабочем потоке
+    QSharedPointer<QCPAxisTickerDateTime> timeTicker;
+    QSharedPointer<QCPAxisTickerFixed> valueTicker;
+    QVector<double> ticks;
+    QVector<QString> tickLabels;
+};
+
+// Виджет графика для фоновой отрисовки: GUI-поток только копирует
+// на экран последний готовый кадр, поэтому ввод не ждет растеризации.
+// Пока рабочий поток занят, хранится лишь самый свежий ожидающий кадр.
+class OffscreenPlotWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit OffscreenPlotWidget(QWidget *parent = nullptr);
+    ~OffscreenPlotWidget();
+
+    void submit(const PlotFrame &frame);
+    // Время растеризации последнего кадра в рабочем потоке, мс
+    double lastRenderMs() const { return lastRenderNs / 1e6; }
+
+signals:
+    // Размер изменился — нужен новый кадр
+    void frameRequested();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private slots:
+    void onFrameRendered(const QImage &image, qint64 renderNs);
+
+private:
+    void dispatch(const PlotFrame &frame);
+
+    QThread renderThread;
+    PlotRenderer *renderer;
+    QImage lastFrame;
+    PlotFrame pendingFrame;
+    bool hasPending = false;
+    bool busy = false;
+    qint64 lastRenderNs = 0;
+};
+
+#endif // PLOTRENDERER_H
@@ -0,0 +1,228 @@
+#include "sparklinegrid.h"
+#include "cpuhistory.h"
+#include "tracing.h"
+#include <QPainter>
+#include <QResizeEvent>
+
+namespace {
+
+const QColor LINE_COLOR(30, 90, 180);
+const QColor OFFLINE_COLOR(170, 170, 170);
+const QColor FRAME_COLOR(200, 200, 200);
+
+} // namespace
+
+SparklineGrid::SparklineGrid(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void SparklineGrid::setTimeWindow(double seconds)
+{
+    if (seconds > 0 && seconds != windowSec) {
+        windowSec = seconds;
+        updateLayout(ranges.size());
+        rebuildNeeded = true;
+    }
+}
+
+void SparklineGrid::invalidate()
+{
+    rebuildNeeded = true;
+}
+
+void SparklineGrid::advance(const CpuHistory &history, double end)
+{
+    TRACE_SCOPE("SparklineGrid::advance");
+
+    windowEnd = end;
+    const int coreCount = history.coreCount();
+    if (coreCount != ranges.size()) {
+        updateLayout(coreCount);
+        rebuildNeeded = true;
+    }
+    online.resize(coreCount);
+    for (int core = 0; core < coreCount; ++core) {
+        online[core] = history.isCoreOnline(core);
+    }
+
+    if (rebuildNeeded) {
+        rebuild(history);
+        update();
+        return;
+    }
+
+    const int first = history.firstRowAfter(lastAddedTime);
+    if (first < 0) {
+        rebuild(history);
+    } else {
+        for (int row = first; row < history.size(); ++row) {
+            addRow(history, row);
+        }
+    }
+    update();
+}
+
+void SparklineGrid::scrollTo(double end)
+{
+    windowEnd = end;
+    update();
+}
+
+void SparklineGrid::updateLayout(int coreCount)
+{
+    const int n = qMax(1, coreCount);
+    const double cellsPerRow = std::sqrt(n * width() / (qMax(1, height()) * CELL_ASPECT));
+    gridColumns = qBound(1, static_cast<int>(std::lround(cellsPerRow)), n);
+    gridRows = (n + gridColumns - 1) / gridColumns;
+
+    const int newColumns = qMax(0, sparklineRect(cellRect(0)).width());
+    if (newColumns != columns) {
+        columns = newColumns;
+        rebuildNeeded = true;
+    }
+    secPerColumn = columns > 0 ? windowSec / columns : 1.0;
+}
+
+void SparklineGrid::rebuild(const CpuHistory &history)
+{
+    TRACE_SCOPE("SparklineGrid::rebuild");
+
+    ranges = QVector<QVector<ColumnRange>>(history.coreCount(), QVector<ColumnRange>(columns));
+    slotBucket = QVector<qint64>(columns, -1);
+    lastAddedTime = std::nan("");
+    rebuildNeeded = false;
+
+    if (columns == 0) {
+        return;
+    }
+    for (int row = 0; row < history.size(); ++row) {
+        addRow(history, row);
+    }
+}
+
+void SparklineGrid::addRow(const CpuHistory &history, int row)
+{
+    const double time = history.timeAt(row);
+    lastAddedTime = time;
+    if (columns == 0) {
+        return;
+    }
+
+    // Слот кольца — интервал времени по модулю числа столбцов
+    const qint64 bucket = static_cast<qint64>(std::floor(time / secPerColumn));
+    const int slot = static_cast<int>(((bucket % columns) + columns) % columns);
+    if (slotBucket[slot] > bucket) {
+        return;
+    }
+    if (slotBucket[slot] < bucket) {
+        slotBucket[slot] = bucket;
+        for (QVector<ColumnRange> &coreRanges : ranges) {
+            coreRanges[slot] = ColumnRange();
+        }
+    }
+
+    for (int core = 0; core < ranges.size(); ++core) {
+        const float value = static_cast<float>(history.coreAt(core, row));
+        if (std::isnan(value)) {
+            continue;
+        }
+        ColumnRange &range = ranges[core][slot];
+        if (std::isnan(range.min)) {
+            range.min = range.max = value;
+        } else {
+            range.min = qMin(range.min, value);
+            range.max = qMax(range.max, value);
+        }
+    }
+}
+
+QRect SparklineGrid::cellRect(int core) const
+{
+    const int column = core % gridColumns;
+    const int row = core / gridColumns;
+    const int left = column * width() / gridColumns;
+    const int top = row * height() / gridRows;
+    const int right = (column + 1) * width() / gridColumns;
+    const int bottom = (row + 1) * height() / gridRows;
+    return QRect(left, top, right - left, bottom - top);
+}
+
+QRect SparklineGrid::sparklineRect(const QRect &cell) const
+{
+    // Подпись помещается, только если ячейка достаточно высокая
+    const int labelHeight = fontMetrics().height();
+    if (cell.height() >= 3 * labelHeight) {
+        return cell.adjusted(3, labelHeight + 1, -3, -3);
+    }
+    return cell.adjusted(1, 1, -1, -1);
+}
+
+void SparklineGrid::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    TRACE_SCOPE("SparklineGrid::paint");
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+    if (columns == 0 || ranges.isEmpty()) {
+        return;
+    }
+
+    // Все отрезки собираются в два массива и рисуются двумя вызовами
+    QVector<QLineF> onlineLines;
+    QVector<QLineF> offlineLines;
+    QVector<QRect> frames;
+    onlineLines.reserve(ranges.size() * columns);
+    frames.reserve(ranges.size());
+
+    const qint64 lastBucket = static_cast<qint64>(std::floor(windowEnd / secPerColumn));
+    const qint64 firstBucket = lastBucket - columns + 1;
+    const bool labels = sparklineRect(cellRect(0)).top() > cellRect(0).top() + 1;
+
+    for (int core = 0; core < ranges.size(); ++core) {
+        const QRect cell = cellRect(core);
+        const QRect area = sparklineRect(cell);
+        frames.append(area);
+        const bool coreOnline = online.value(core, true);
+
+        if (labels) {
+            painter.setPen(coreOnline ? palette().text().color() : OFFLINE_COLOR);
+            painter.drawText(cell.adjusted(3, 0, -3, 0), Qt::AlignLeft | Qt::AlignTop, QString::number(core));
+        }
+
+        // Ось Y у всех графиков одна, 0..100%, чтобы ядра можно было сравнивать
+        const double yScale = (area.height() - 1) / 100.0;
+        QVector<QLineF> &lines = coreOnline ? onlineLines : offlineLines;
+        const QVector<ColumnRange> &coreRanges = ranges[core];
+        for (int x = 0; x < columns && x < area.width(); ++x) {
+            const qint64 bucket = firstBucket + x;
+            const int slot = static_cast<int>(((bucket % columns) + columns) % columns);
+            const ColumnRange &range = coreRanges[slot];
+            if (slotBucket[slot] != bucket || std::isnan(range.min)) {
+                continue;
+            }
+            const qreal px = area.left() + x + 0.5;
+            const qreal yLow = area.bottom() - range.min * yScale;
+            const qreal yHigh = area.bottom() - range.max * yScale;
+            lines.append(QLineF(px, yLow + 0.5, px, qMin(yHigh, yLow - 1.0) + 0.5));
+        }
+    }
+
+    painter.setPen(FRAME_COLOR);
+    painter.drawRects(frames);
+    painter.setPen(QPen(LINE_COLOR, 0));
+    painter.drawLines(onlineLines);
+    painter.setPen(QPen(OFFLINE_COLOR, 0));
+    painter.drawLines(offlineLines);
+}
+
+void SparklineGrid::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    updateLayout(ranges.size());
+    if (rebuildNeeded) {
+        emit rebuildRequested();
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef SPARKLINEGRID_H
+#define SPARKLINEGRID_H
+
+#include <QVector>
+#include <QWidget>
+#include <cmath>
+
+class CpuHistory;
+
+// Сетка маленьких графиков («small multiples»): по одному на ядро, все
+// рисуются одним виджетом за один проход, без QCPAxisRect на ядро.
+// Для каждого ядра хранится минимум и максимум по столбцам пикселей;
+// столбец привязан к интервалу времени, поэтому новые строки истории
+// обновляют только свой столбец, а сдвиг окна ничего не пересчитывает.
+class SparklineGrid : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit SparklineGrid(QWidget *parent = nullptr);
+
+    void setTimeWindow(double seconds);
+    // Следующий advance() пересчитает столбцы из всей истории (смена хоста)
+    void invalidate();
+
+    // Учитывает строки истории новее уже учтенных; правый край окна — windowEnd
+    void advance(const CpuHistory &history, double windowEnd);
+    // Сдвиг окна без новых данных
+    void scrollTo(double windowEnd);
+
+signals:
+    // Изменилась ширина ячеек — нужен пересчет из истории
+    void rebuildRequested();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    // Диапазон значений одного столбца; пустой, если min — NaN
+    struct ColumnRange
+    {
+        float min = std::nanf("");
+        float max = std::nanf("");
+    };
+
+    void updateLayout(int coreCount);
+    void rebuild(const CpuHistory &history);
+    void addRow(const CpuHistory &history, int row);
+    QRect cellRect(int core) const;
+    QRect sparklineRect(const QRect &cell) const;
+
+    // Желаемое отношение ширины ячейки к высоте
+    static constexpr double CELL_ASPECT = 3.0;
+
+    double windowSec = 300.0;
+    double windowEnd = 0.0;
+    int gridColumns = 1;
+    int gridRows = 1;
+    int columns = 0;                     // столбцов пикселей в одном графике
+    double secPerColumn = 1.0;
+    QVector<qint64> slotBucket;          // интервал времени в каждом слоте кольца
+    QVector<QVector<ColumnRange>> ranges; // [ядро][слот]
+    QVector<bool> online;
+    double lastAddedTime = std::nan("");
+    bool rebuildNeeded = true;
+};
+
+#endif // SPARKLINEGRID_H
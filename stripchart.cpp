@@ -0,0 +1,251 @@
+#include "stripchart.h"
+#include "cpuhistory.h"
+#include "tracing.h"
+#include <QDateTime>
+#include <QPainter>
+#include <QPolygonF>
+#include <QResizeEvent>
+
+namespace {
+
+constexpr int MARGIN_LEFT = 48;
+constexpr int MARGIN_RIGHT = 12;
+constexpr int MARGIN_TOP = 10;
+constexpr int MARGIN_BOTTOM = 28;
+constexpr int X_TICK_SEC = 60;
+
+const QColor BACKGROUND(240, 240, 240);
+const QColor GRID(180, 180, 180);
+
+} // namespace
+
+StripChartWidget::StripChartWidget(QWidget *parent)
+    : QWidget(parent)
+{
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void StripChartWidget::setTimeWindow(double seconds)
+{
+    if (seconds > 0 && seconds != windowSec) {
+        windowSec = seconds;
+        fullRedrawNeeded = true;
+    }
+}
+
+void StripChartWidget::setYAxis(double max, double tickStep)
+{
+    if (max > 0 && (max != yMax || tickStep != yTickStep)) {
+        yMax = max;
+        yTickStep = tickStep;
+        fullRedrawNeeded = true;
+    }
+}
+
+void StripChartWidget::setCoreColors(const QVector<QColor> &colors)
+{
+    if (colors != coreColors) {
+        coreColors = colors;
+        fullRedrawNeeded = true;
+    }
+}
+
+void StripChartWidget::invalidate()
+{
+    fullRedrawNeeded = true;
+}
+
+void StripChartWidget::advance(const CpuHistory &history, double windowEnd)
+{
+    TRACE_SCOPE("StripChartWidget::advance");
+
+    if (strip.isNull() || history.isEmpty()) {
+        return;
+    }
+    if (fullRedrawNeeded || windowEnd < stripEndTime) {
+        redrawAll(history, windowEnd);
+        return;
+    }
+
+    const int first = history.firstRowAfter(lastDrawnTime);
+    if (first < 0) {
+        redrawAll(history, windowEnd);
+        return;
+    }
+
+    scrollTo(windowEnd);
+    drawSegments(history, first);
+    lastDrawnTime = history.lastTime();
+    update();
+}
+
+void StripChartWidget::redrawAll(const CpuHistory &history, double windowEnd)
+{
+    TRACE_SCOPE("StripChartWidget::redrawAll");
+
+    stripEndTime = windowEnd;
+    clearColumns(0, strip.width());
+
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const qreal dpr = devicePixelRatioF();
+
+    // NaN разрывает линию, как у QCPGraph
+    QPolygonF segment;
+    segment.reserve(history.size());
+    auto drawSeries = [&](auto valueAt) {
+        segment.clear();
+        for (int row = 0; row < history.size(); ++row) {
+            const double value = valueAt(row);
+            if (std::isnan(value)) {
+                if (segment.size() > 1) {
+                    painter.drawPolyline(segment);
+                }
+                segment.clear();
+                continue;
+            }
+            segment.append(QPointF(xForTime(history.timeAt(row)), yForValue(value)));
+        }
+        if (segment.size() > 1) {
+            painter.drawPolyline(segment);
+        }
+    };
+
+    for (int core = 0; core < history.coreCount() && core < coreColors.size(); ++core) {
+        painter.setPen(QPen(coreColors[core], dpr));
+        drawSeries([&](int row) { return history.coreAt(core, row); });
+    }
+    painter.setPen(QPen(Qt::black, 4 * dpr, Qt::SolidLine, Qt::RoundCap));
+    drawSeries([&](int row) { return history.totalAt(row); });
+    painter.end();
+
+    lastDrawnTime = history.lastTime();
+    fullRedrawNeeded = false;
+    update();
+}
+
+void StripChartWidget::scrollTo(double windowEnd)
+{
+    const double pxPerSec = strip.width() / windowSec;
+    const int dx = static_cast<int>(std::floor((windowEnd - stripEndTime) * pxPerSec));
+    if (dx <= 0) {
+        return;
+    }
+    if (dx >= strip.width()) {
+        stripEndTime = windowEnd;
+        clearColumns(0, strip.width());
+        return;
+    }
+
+    // Дробная часть сдвига накапливается в stripEndTime
+    strip.scroll(-dx, 0, strip.rect());
+    stripEndTime += dx / pxPerSec;
+    clearColumns(strip.width() - dx, dx);
+}
+
+void StripChartWidget::clearColumns(int x, int width)
+{
+    QPainter painter(&strip);
+    const QRect columns(x, 0, width, strip.height());
+    painter.fillRect(columns, BACKGROUND);
+    painter.setClipRect(columns);
+    painter.setPen(QPen(GRID, devicePixelRatioF()));
+
+    for (double y = 0.0; y <= yMax + 1e-9; y += yTickStep) {
+        const qreal py = yForValue(y);
+        painter.drawLine(QPointF(x, py), QPointF(x + width, py));
+    }
+
+    // Вертикальные линии сетки по целым минутам, попавшие в эти столбцы
+    const double pxPerSec = strip.width() / windowSec;
+    const double fromTime = stripEndTime - (strip.width() - x) / pxPerSec;
+    const double toTime = fromTime + width / pxPerSec;
+    for (double t = std::ceil(fromTime / X_TICK_SEC) * X_TICK_SEC; t <= toTime; t += X_TICK_SEC) {
+        const qreal px = xForTime(t);
+        painter.drawLine(QPointF(px, 0), QPointF(px, strip.height()));
+    }
+}
+
+void StripChartWidget::drawSegments(const CpuHistory &history, int fromRow)
+{
+    QPainter painter(&strip);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const qreal dpr = devicePixelRatioF();
+
+    for (int row = qMax(1, fromRow); row < history.size(); ++row) {
+        const qreal x0 = xForTime(history.timeAt(row - 1));
+        const qreal x1 = xForTime(history.timeAt(row));
+
+        for (int core = 0; core < history.coreCount() && core < coreColors.size(); ++core) {
+            const double v0 = history.coreAt(core, row - 1);
+            const double v1 = history.coreAt(core, row);
+            if (std::isnan(v0) || std::isnan(v1)) {
+                continue;
+            }
+            painter.setPen(QPen(coreColors[core], dpr));
+            painter.drawLine(QPointF(x0, yForValue(v0)), QPointF(x1, yForValue(v1)));
+        }
+
+        const double t0 = history.totalAt(row - 1);
+        const double t1 = history.totalAt(row);
+        if (!std::isnan(t0) && !std::isnan(t1)) {
+            painter.setPen(QPen(Qt::black, 4 * dpr, Qt::SolidLine, Qt::RoundCap));
+            painter.drawLine(QPointF(x0, yForValue(t0)), QPointF(x1, yForValue(t1)));
+        }
+    }
+}
+
+double StripChartWidget::xForTime(double time) const
+{
+    return strip.width() - (stripEndTime - time) * strip.width() / windowSec;
+}
+
+double StripChartWidget::yForValue(double value) const
+{
+    return strip.height() - value / yMax * strip.height();
+}
+
+QRect StripChartWidget::plotArea() const
+{
+    return rect().adjusted(MARGIN_LEFT, MARGIN_TOP, -MARGIN_RIGHT, -MARGIN_BOTTOM);
+}
+
+void StripChartWidget::paintEvent(QPaintEvent *event)
+{
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.fillRect(rect(), BACKGROUND);
+
+    const QRect area = plotArea();
+    if (strip.isNull() || area.isEmpty()) {
+        return;
+    }
+    painter.drawPixmap(area, strip);
+    painter.setPen(Qt::black);
+    painter.drawRect(area);
+
+    // Подписи осей рисуются поверх, по текущему положению ленты
+    const QFontMetrics metrics = painter.fontMetrics();
+    for (double y = 0.0; y <= yMax + 1e-9; y += yTickStep) {
+        const qreal py = area.bottom() - y / yMax * area.height();
+        painter.drawText(QRectF(0, py - metrics.height() / 2.0, MARGIN_LEFT - 4, metrics.height()),
+                         Qt::AlignRight | Qt::AlignVCenter, QString::number(y, 'g', 4));
+    }
+
+    const double startTime = stripEndTime - windowSec;
+    for (double t = std::ceil(startTime / X_TICK_SEC) * X_TICK_SEC; t <= stripEndTime; t += X_TICK_SEC) {
+        const qreal px = area.left() + (t - startTime) / windowSec * area.width();
+        const QString label = QDateTime::fromSecsSinceEpoch(static_cast<qint64>(t)).toString("HH.mm");
+        painter.drawText(QRectF(px - 40, area.bottom() + 4, 80, metrics.height()), Qt::AlignHCenter, label);
+    }
+}
+
+void StripChartWidget::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+
+    const QSize size = plotArea().size() * devicePixelRatioF();
+    strip = size.isEmpty() ? QPixmap() : QPixmap(size);
+    fullRedrawNeeded = true;
+    emit redrawRequested();
+}
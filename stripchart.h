@@ -0,0 +1,61 @@
+#ifndef STRIPCHART_H
+#define STRIPCHART_H
+
+#include <QColor>
+#include <QPixmap>
+#include <QVector>
+#include <QWidget>
+#include <cmath>
+
+class CpuHistory;
+
+// Ленточный самописец: нарисованная область хранится в QPixmap, при новом
+// сэмпле она сдвигается влево на прошедшее число пикселей и дорисовываются
+// только последние отрезки линий. Стоимость сэмпла не зависит от длины окна;
+// полностью картинка перерисовывается при изменении размера, смене окна
+// по времени, масштаба оси Y или набора ядер.
+class StripChartWidget : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit StripChartWidget(QWidget *parent = nullptr);
+
+    void setTimeWindow(double seconds);
+    void setYAxis(double yMax, double tickStep);
+    void setCoreColors(const QVector<QColor> &colors);
+    // Следующий advance() перерисует окно целиком (например, при смене хоста)
+    void invalidate();
+
+    // Сдвигает окно так, чтобы правый край был windowEnd, и дорисовывает
+    // строки истории новее уже нарисованных
+    void advance(const CpuHistory &history, double windowEnd);
+
+signals:
+    // Размер изменился — нужна полная перерисовка из истории
+    void redrawRequested();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+
+private:
+    void redrawAll(const CpuHistory &history, double windowEnd);
+    void scrollTo(double windowEnd);
+    void clearColumns(int x, int width);
+    void drawSegments(const CpuHistory &history, int fromRow);
+    double xForTime(double time) const;
+    double yForValue(double value) const;
+    QRect plotArea() const;
+
+    QPixmap strip;               // область графика в физических пикселях
+    double windowSec = 300.0;
+    double yMax = 100.0;
+    double yTickStep = 10.0;
+    QVector<QColor> coreColors;
+    double stripEndTime = 0.0;   // время правого края strip
+    double lastDrawnTime = std::nan("");
+    bool fullRedrawNeeded = true;
+};
+
+#endif // STRIPCHART_H
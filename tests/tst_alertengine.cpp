@@ -0,0 +1,162 @@
+#include "alertengine.h"
+#include <QSignalSpy>
+#include <QtTest>
+
+class TestAlertEngine : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parseRules_data();
+    void parseRules();
+    void parseInvalid_data();
+    void parseInvalid();
+    void hysteresis();
+    void sustainedDuration();
+
+private:
+    static AlertRule rule(const QString &text);
+    static void addTotal(AlertEngine &engine, double timeSec, double total);
+    static AlertEvent eventAt(const QSignalSpy &spy, int index);
+};
+
+AlertRule TestAlertEngine::rule(const QString &text)
+{
+    AlertRule parsed;
+    QString error;
+    if (!AlertRule::parse(text, parsed, &error)) {
+        qWarning() << error;
+    }
+    return parsed;
+}
+
+void TestAlertEngine::addTotal(AlertEngine &engine, double timeSec, double total)
+{
+    engine.addSample("host", timeSec, QVector<double>({total}), total, CoreImbalance());
+}
+
+AlertEvent TestAlertEngine::eventAt(const QSignalSpy &spy, int index)
+{
+    return qvariant_cast<AlertEvent>(spy.at(index).at(0));
+}
+
+void TestAlertEngine::parseRules_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<int>("series");
+    QTest::addColumn<double>("threshold");
+    QTest::addColumn<double>("clearThreshold");
+    QTest::addColumn<double>("durationSec");
+
+    const int sustained = static_cast<int>(AlertRule::Kind::Sustained);
+    const int average = static_cast<int>(AlertRule::Kind::Average);
+    QTest::newRow("total avg") << "total > 80 avg 5m" << average
+                               << static_cast<int>(AlertRule::Series::Total) << 80.0 << 75.0 << 300.0;
+    QTest::newRow("core for") << "core > 95 for 30s" << sustained
+                              << static_cast<int>(AlertRule::Series::AnyCore) << 95.0 << 90.0 << 30.0;
+    QTest::newRow("gini hysteresis") << "gini > 0.5 for 10" << sustained
+                                     << static_cast<int>(AlertRule::Series::Gini) << 0.5 << 0.45 << 10.0;
+    QTest::newRow("explicit clear") << "spread > 60% for 1h clear 40" << sustained
+                                    << static_cast<int>(AlertRule::Series::Spread) << 60.0 << 40.0 << 3600.0;
+    QTest::newRow("case and spaces") << "  StdDev  >  20   FOR 0s " << sustained
+                                     << static_cast<int>(AlertRule::Series::StdDev) << 20.0 << 15.0 << 0.0;
+}
+
+void TestAlertEngine::parseRules()
+{
+    QFETCH(QString, text);
+    QFETCH(int, kind);
+    QFETCH(int, series);
+    QFETCH(double, threshold);
+    QFETCH(double, clearThreshold);
+    QFETCH(double, durationSec);
+
+    AlertRule parsed;
+    QVERIFY(AlertRule::parse(text, parsed));
+    QCOMPARE(static_cast<int>(parsed.kind), kind);
+    QCOMPARE(static_cast<int>(parsed.series), series);
+    QCOMPARE(parsed.threshold, threshold);
+    QCOMPARE(parsed.clearThreshold, clearThreshold);
+    QCOMPARE(parsed.durationSec, durationSec);
+}
+
+void TestAlertEngine::parseInvalid_data()
+{
+    QTest::addColumn<QString>("text");
+
+    QTest::newRow("unknown series") << "load > 5 for 1s";
+    QTest::newRow("missing duration") << "total > 80";
+    QTest::newRow("bad unit") << "total > 80 for 5d";
+    QTest::newRow("empty average window") << "total > 80 avg 0s";
+    QTest::newRow("clear above threshold") << "total > 80 for 5s clear 90";
+    QTest::newRow("bad clear") << "total > 80 for 5s clear x";
+    QTest::newRow("missing without duration") << "missing 0s";
+}
+
+void TestAlertEngine::parseInvalid()
+{
+    QFETCH(QString, text);
+
+    AlertRule parsed;
+    QString error;
+    QVERIFY(!AlertRule::parse(text, parsed, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestAlertEngine::hysteresis()
+{
+    AlertEngine engine;
+    engine.setRules({rule("total > 80 for 0s")});
+    QSignalSpy spy(&engine, &AlertEngine::alertChanged);
+
+    addTotal(engine, 0.0, 85.0);
+    QCOMPARE(spy.count(), 1);
+    QVERIFY(eventAt(spy, 0).state == AlertEvent::State::Firing);
+    QCOMPARE(engine.activeCount(), 1);
+
+    // Ниже порога, но выше порога снятия (75) — оповещение держится
+    addTotal(engine, 1.0, 78.0);
+    QCOMPARE(spy.count(), 1);
+
+    addTotal(engine, 2.0, 74.0);
+    QCOMPARE(spy.count(), 2);
+    QVERIFY(eventAt(spy, 1).state == AlertEvent::State::Resolved);
+    QCOMPARE(eventAt(spy, 1).value, 74.0);
+    QCOMPARE(engine.activeCount(), 0);
+
+    // Между порогами после снятия — снова не срабатывает
+    addTotal(engine, 3.0, 79.0);
+    QCOMPARE(spy.count(), 2);
+
+    addTotal(engine, 4.0, 81.0);
+    QCOMPARE(spy.count(), 3);
+    QVERIFY(eventAt(spy, 2).state == AlertEvent::State::Firing);
+}
+
+void TestAlertEngine::sustainedDuration()
+{
+    AlertEngine engine;
+    engine.setRules({rule("total > 80 for 10s")});
+    QSignalSpy spy(&engine, &AlertEngine::alertChanged);
+
+    addTotal(engine, 0.0, 90.0);
+    addTotal(engine, 5.0, 90.0);
+    QCOMPARE(spy.count(), 0);
+
+    // Провал ниже порога сбрасывает отсчет
+    addTotal(engine, 6.0, 50.0);
+    addTotal(engine, 7.0, 90.0);
+    addTotal(engine, 16.0, 90.0);
+    QCOMPARE(spy.count(), 0);
+
+    addTotal(engine, 17.0, 90.0);
+    QCOMPARE(spy.count(), 1);
+    const AlertEvent event = eventAt(spy, 0);
+    QVERIFY(event.state == AlertEvent::State::Firing);
+    QCOMPARE(event.hostId, QString("host"));
+    QCOMPARE(event.timeSec, 17.0);
+}
+
+QTEST_GUILESS_MAIN(TestAlertEngine)
+#include "tst_alertengine.moc"
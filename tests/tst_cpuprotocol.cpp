@@ -0,0 +1,140 @@
+#include "cpuprotocol.h"
+#include <QtTest>
+#include <cmath>
+
+class TestCpuProtocol : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void plainSample();
+    void headersAndCoreGaps();
+    void channels();
+    void topology();
+    void fragment();
+    void invalid_data();
+    void invalid();
+    void hostIdForSender();
+};
+
+void TestCpuProtocol::plainSample()
+{
+    CpuSample sample;
+    QVERIFY(CpuProtocol::parseDatagram("Total: 42.5%\nCore 0: 40.0%\nCore 1: 45.0%\n", "10.0.0.1", sample));
+
+    QCOMPARE(sample.hostId, QString("10.0.0.1"));
+    QVERIFY(!sample.hasSequence);
+    QVERIFY(sample.hasTotal);
+    QCOMPARE(sample.total, 42.5);
+    QCOMPARE(sample.coreUsages, QVector<double>({40.0, 45.0}));
+    QVERIFY(sample.topology.isEmpty());
+    QVERIFY(sample.channels.isEmpty());
+    QVERIFY(!sample.fragmented);
+}
+
+void TestCpuProtocol::headersAndCoreGaps()
+{
+    CpuSample sample;
+    QVERIFY(CpuProtocol::parseDatagram("Host: web-1\nSeq: 7\nTotal: 20%\nCore 0: 10%\nCore 2: 30%",
+                                       "10.0.0.1", sample));
+
+    QCOMPARE(sample.hostId, QString("web-1"));
+    QVERIFY(sample.hasSequence);
+    QCOMPARE(sample.sequence, quint32(7));
+    // Непереданное ядро 1 — offline
+    QCOMPARE(sample.coreUsages.size(), 3);
+    QCOMPARE(sample.coreUsages[0], 10.0);
+    QVERIFY(std::isnan(sample.coreUsages[1]));
+    QCOMPARE(sample.coreUsages[2], 30.0);
+}
+
+void TestCpuProtocol::channels()
+{
+    CpuSample sample;
+    QVERIFY(CpuProtocol::parseDatagram("Total: 55%\n"
+                                       "Core 0: 50% user=40 sys=10\n"
+                                       "Core 1: 60% freq=2400 future=1",
+                                       "h", sample));
+
+    QCOMPARE(sample.coreUsages, QVector<double>({50.0, 60.0}));
+    QVERIFY(sample.channels.has(MetricChannel::User));
+    QVERIFY(sample.channels.has(MetricChannel::System));
+    QVERIFY(sample.channels.has(MetricChannel::Frequency));
+    QVERIFY(!sample.channels.has(MetricChannel::IoWait));
+
+    // Каналы выровнены по числу ядер; непереданные значения — NaN
+    const QVector<double> &user = sample.channels.perCore[static_cast<int>(MetricChannel::User)];
+    QCOMPARE(user.size(), 2);
+    QCOMPARE(user[0], 40.0);
+    QVERIFY(std::isnan(user[1]));
+    const QVector<double> &freq = sample.channels.perCore[static_cast<int>(MetricChannel::Frequency)];
+    QCOMPARE(freq.size(), 2);
+    QVERIFY(std::isnan(freq[0]));
+    QCOMPARE(freq[1], 2400.0);
+}
+
+void TestCpuProtocol::topology()
+{
+    CpuSample sample;
+    QVERIFY(CpuProtocol::parseDatagram("Topo: 0.0.0 0.0.0 0.1.1 1.2.0\n"
+                                       "Total: 20%\n"
+                                       "Core 0: 10%\nCore 1: 20%\nCore 2: 30%\nCore 3: 20%",
+                                       "h", sample));
+
+    QCOMPARE(sample.topology.size(), 4);
+    QVERIFY(sample.topology[0] == sample.topology[1]);
+    QCOMPARE(sample.topology[2].socket, 0);
+    QCOMPARE(sample.topology[2].node, 1);
+    QCOMPARE(sample.topology[2].physicalCore, 1);
+    QCOMPARE(sample.topology[3].socket, 1);
+    QCOMPARE(sample.coreUsages.size(), 4);
+}
+
+void TestCpuProtocol::fragment()
+{
+    // Фрагмент с index > 0 идет без строки Total; номера ядер — от coreOffset
+    CpuSample sample;
+    QVERIFY(CpuProtocol::parseDatagram("Host: big\nFrag: 9 1/2 2 4\nCore 2: 10%\nCore 3: 20%", "h", sample));
+
+    QVERIFY(sample.fragmented);
+    QCOMPARE(sample.fragment.sampleId, quint32(9));
+    QCOMPARE(sample.fragment.index, 1);
+    QCOMPARE(sample.fragment.count, 2);
+    QCOMPARE(sample.fragment.coreOffset, 2);
+    QCOMPARE(sample.fragment.coreCount, 4);
+    QVERIFY(!sample.hasTotal);
+    QCOMPARE(sample.coreUsages, QVector<double>({10.0, 20.0}));
+}
+
+void TestCpuProtocol::invalid_data()
+{
+    QTest::addColumn<QByteArray>("datagram");
+
+    QTest::newRow("no total") << QByteArray("Core 0: 10%");
+    QTest::newRow("no cores") << QByteArray("Total: 10%");
+    QTest::newRow("bad sequence") << QByteArray("Seq: x\nTotal: 10%\nCore 0: 10%");
+    QTest::newRow("bad topology") << QByteArray("Topo: 0.0\nTotal: 10%\nCore 0: 10%");
+    QTest::newRow("topology too long") << QByteArray("Frag: 1 0/1 0 1\nTopo: 0.0.0 0.0.1\nTotal: 10%\nCore 0: 10%");
+    QTest::newRow("fragment count") << QByteArray("Frag: 1 2/2 0 4\nCore 0: 10%");
+    QTest::newRow("cores past fragment") << QByteArray("Frag: 1 0/1 3 4\nTotal: 10%\nCore 3: 10%\nCore 4: 10%");
+}
+
+void TestCpuProtocol::invalid()
+{
+    QFETCH(QByteArray, datagram);
+
+    CpuSample sample;
+    QString error;
+    QVERIFY(!CpuProtocol::parseDatagram(datagram, "h", sample, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+void TestCpuProtocol::hostIdForSender()
+{
+    QCOMPARE(CpuProtocol::hostIdForSender("10.0.0.1:5000"), QString("10.0.0.1"));
+    QCOMPARE(CpuProtocol::hostIdForSender("::ffff:10.0.0.1:5000"), QString("::ffff:10.0.0.1"));
+    QCOMPARE(CpuProtocol::hostIdForSender("localhost"), QString("localhost"));
+}
+
+QTEST_APPLESS_MAIN(TestCpuProtocol)
+#include "tst_cpuprotocol.moc"
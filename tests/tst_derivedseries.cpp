@@ -0,0 +1,111 @@
+#include "derivedseries.h"
+#include <QtTest>
+#include <cmath>
+
+class TestDerivedSeries : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void parse_data();
+    void parse();
+    void ema();
+    void sma();
+    void movingMax();
+
+private:
+    static DerivedFilter filter(DerivedSpec::Kind kind, double param);
+};
+
+DerivedFilter TestDerivedSeries::filter(DerivedSpec::Kind kind, double param)
+{
+    DerivedSpec spec;
+    spec.kind = kind;
+    spec.param = param;
+    return DerivedFilter(spec);
+}
+
+void TestDerivedSeries::parse_data()
+{
+    QTest::addColumn<QString>("text");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<int>("kind");
+    QTest::addColumn<double>("param");
+
+    const int none = static_cast<int>(DerivedSpec::Kind::None);
+    QTest::newRow("raw") << "raw" << true << none << 0.0;
+    QTest::newRow("empty") << "" << true << none << 0.0;
+    QTest::newRow("ema") << "EMA:2.5" << true << static_cast<int>(DerivedSpec::Kind::Ema) << 2.5;
+    QTest::newRow("sma") << "sma:30" << true << static_cast<int>(DerivedSpec::Kind::Sma) << 30.0;
+    QTest::newRow("max") << " max:100 " << true << static_cast<int>(DerivedSpec::Kind::MovingMax) << 100.0;
+    QTest::newRow("above history") << "sma:101" << false << none << 0.0;
+    QTest::newRow("zero window") << "max:0" << false << none << 0.0;
+    QTest::newRow("fractional window") << "sma:2.5" << false << none << 0.0;
+    QTest::newRow("half-life step") << "ema:0.015" << false << none << 0.0;
+    QTest::newRow("unknown") << "median:5" << false << none << 0.0;
+    QTest::newRow("no parameter") << "ema" << false << none << 0.0;
+}
+
+void TestDerivedSeries::parse()
+{
+    QFETCH(QString, text);
+    QFETCH(bool, valid);
+    QFETCH(int, kind);
+    QFETCH(double, param);
+
+    DerivedSpec spec;
+    QString error;
+    QCOMPARE(DerivedSpec::parse(text, spec, 100, &error), valid);
+    QCOMPARE(error.isEmpty(), valid);
+    QCOMPARE(static_cast<int>(spec.kind), kind);
+    QCOMPARE(spec.param, param);
+}
+
+void TestDerivedSeries::ema()
+{
+    // Полураспад 10 с: через 10 с до нового значения остается половина разницы
+    DerivedFilter ema = filter(DerivedSpec::Kind::Ema, 10.0);
+    QCOMPARE(ema.add(0.0, 0.0), 0.0);
+    QCOMPARE(ema.add(10.0, 100.0), 50.0);
+    QCOMPARE(ema.add(20.0, 100.0), 75.0);
+    // Через 5 с — доля 1 − 2^(−0.5)
+    QVERIFY(qAbs(ema.add(25.0, 0.0) - 75.0 * std::exp2(-0.5)) < 1e-12);
+
+    // NaN не сдвигает время последнего значения: разрыв учитывается по времени
+    DerivedFilter gap = filter(DerivedSpec::Kind::Ema, 10.0);
+    gap.add(0.0, 0.0);
+    QVERIFY(std::isnan(gap.add(10.0, std::nan(""))));
+    QCOMPARE(gap.add(20.0, 100.0), 75.0);
+}
+
+void TestDerivedSeries::sma()
+{
+    DerivedFilter sma = filter(DerivedSpec::Kind::Sma, 3);
+    QCOMPARE(sma.add(0.0, 3.0), 3.0);
+    QCOMPARE(sma.add(1.0, 6.0), 4.5);
+    QCOMPARE(sma.add(2.0, 9.0), 6.0);
+    QCOMPARE(sma.add(3.0, 12.0), 9.0);
+    // NaN занимает место в окне, но в среднее не входит
+    QVERIFY(std::isnan(sma.add(4.0, std::nan(""))));
+    QCOMPARE(sma.add(5.0, 15.0), 13.5);
+    QCOMPARE(sma.add(6.0, 18.0), 16.5);
+    QCOMPARE(sma.add(7.0, 21.0), 18.0);
+}
+
+void TestDerivedSeries::movingMax()
+{
+    DerivedFilter max = filter(DerivedSpec::Kind::MovingMax, 3);
+    const double input[] = {5.0, 1.0, 3.0, 2.0, 0.0, 4.0, 4.0, 1.0, 1.0};
+    const double expected[] = {5.0, 5.0, 5.0, 3.0, 3.0, 4.0, 4.0, 4.0, 4.0};
+    for (int i = 0; i < 9; ++i) {
+        QCOMPARE(max.add(i, input[i]), expected[i]);
+    }
+
+    // NaN выходит из окна, как обычное значение
+    QVERIFY(std::isnan(max.add(9.0, std::nan(""))));
+    QCOMPARE(max.add(10.0, 0.0), 1.0);
+    QCOMPARE(max.add(11.0, 0.0), 0.0);
+}
+
+QTEST_APPLESS_MAIN(TestDerivedSeries)
+#include "tst_derivedseries.moc"
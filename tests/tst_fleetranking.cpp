@@ -0,0 +1,93 @@
+#include "fleetranking.h"
+#include <QtTest>
+
+class TestFleetRanking : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void orderByCurrent();
+    void tiesKeepArrivalOrder();
+    void windowAverage();
+    void limit();
+
+private:
+    static QStringList ids(const FleetRanking &ranking, FleetRanking::Key key, int limit = -1);
+};
+
+QStringList TestFleetRanking::ids(const FleetRanking &ranking, FleetRanking::Key key, int limit)
+{
+    QVector<const HostSummary*> ranked;
+    ranking.ranked(key, ranked, limit);
+    QStringList result;
+    for (const HostSummary *summary : ranked) {
+        result.append(summary->id);
+    }
+    return result;
+}
+
+void TestFleetRanking::orderByCurrent()
+{
+    FleetRanking ranking;
+    ranking.update("a", 10.0, 1000);
+    ranking.update("b", 50.0, 1000);
+    ranking.update("c", 30.0, 1000);
+    QCOMPARE(ranking.hostCount(), 3);
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current), QStringList({"b", "c", "a"}));
+
+    // Обновление переставляет хост без пересортировки остальных
+    ranking.update("b", 5.0, 2000);
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current), QStringList({"c", "a", "b"}));
+    QCOMPARE(ranking.summary("b")->current, 5.0);
+    QCOMPARE(ranking.summary("b")->lastSeenMs, qint64(2000));
+    QVERIFY(!ranking.summary("missing"));
+}
+
+void TestFleetRanking::tiesKeepArrivalOrder()
+{
+    FleetRanking ranking;
+    ranking.update("first", 40.0, 0);
+    ranking.update("second", 40.0, 0);
+    ranking.update("third", 40.0, 0);
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current), QStringList({"first", "second", "third"}));
+
+    // Хост, догнавший остальных, встает по порядку появления, а не в конец
+    ranking.update("first", 10.0, 1);
+    ranking.update("first", 40.0, 2);
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current), QStringList({"first", "second", "third"}));
+}
+
+void TestFleetRanking::windowAverage()
+{
+    FleetRanking ranking;
+    ranking.update("steady", 30.0, 0);
+    ranking.update("spiky", 50.0, 0);
+    ranking.update("spiky", 0.0, 1);
+
+    // Среднее «spiky» за окно — 25, поэтому по окну он ниже, чем по текущему
+    QCOMPARE(ranking.summary("spiky")->windowAverage, 25.0);
+    QCOMPARE(ids(ranking, FleetRanking::Key::WindowAverage), QStringList({"steady", "spiky"}));
+
+    // Окно — последние TREND_POINTS сэмплов
+    for (int i = 0; i < HostSummary::TREND_POINTS; ++i) {
+        ranking.update("spiky", 100.0, 2 + i);
+    }
+    const HostSummary *spiky = ranking.summary("spiky");
+    QCOMPARE(spiky->trendSize(), HostSummary::TREND_POINTS);
+    QCOMPARE(spiky->windowAverage, 100.0);
+    QCOMPARE(spiky->trendAt(0), 100.0f);
+    QCOMPARE(ids(ranking, FleetRanking::Key::WindowAverage), QStringList({"spiky", "steady"}));
+}
+
+void TestFleetRanking::limit()
+{
+    FleetRanking ranking;
+    for (int i = 0; i < 10; ++i) {
+        ranking.update(QString("host-%1").arg(i), i * 10.0, 0);
+    }
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current, 3), QStringList({"host-9", "host-8", "host-7"}));
+    QCOMPARE(ids(ranking, FleetRanking::Key::Current, 100).size(), 10);
+}
+
+QTEST_APPLESS_MAIN(TestFleetRanking)
+#include "tst_fleetranking.moc"
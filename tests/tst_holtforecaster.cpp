@@ -0,0 +1,72 @@
+#include "holtforecaster.h"
+#include <QtTest>
+#include <cmath>
+
+class TestHoltForecaster : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void warmUp();
+    void repeatedTimeDoesNotCount();
+    void linearTrend();
+    void clampsForecast();
+};
+
+void TestHoltForecaster::warmUp()
+{
+    // Прогноз появляется только после 30 сэмплов
+    HoltForecaster forecaster;
+    for (int t = 0; t < 29; ++t) {
+        forecaster.add(t, 50.0);
+        QVERIFY(!forecaster.isReady());
+        QVERIFY(std::isnan(forecaster.forecast(60.0)));
+    }
+    forecaster.add(29.0, 50.0);
+    QVERIFY(forecaster.isReady());
+    QVERIFY(qAbs(forecaster.forecast(60.0) - 50.0) < 1e-3);
+    QVERIFY(qAbs(forecaster.trendPerMinute()) < 1e-3);
+}
+
+void TestHoltForecaster::repeatedTimeDoesNotCount()
+{
+    // Сэмплы с тем же временем и NaN не продвигают прогрев
+    HoltForecaster forecaster;
+    for (int t = 0; t < 29; ++t) {
+        forecaster.add(t, 50.0);
+    }
+    forecaster.add(28.0, 90.0);
+    forecaster.add(29.0, std::nan(""));
+    QVERIFY(!forecaster.isReady());
+    QCOMPARE(forecaster.lastTime(), 28.0);
+
+    forecaster.add(29.0, 50.0);
+    QVERIFY(forecaster.isReady());
+}
+
+void TestHoltForecaster::linearTrend()
+{
+    // Рост на 0.1% в секунду — 6% в минуту; через 300 с тренд устанавливается
+    HoltForecaster forecaster;
+    for (int t = 0; t < 300; ++t) {
+        forecaster.add(t, 10.0 + 0.1 * t);
+    }
+    QVERIFY(qAbs(forecaster.trendPerMinute() - 6.0) < 0.05);
+    const double expected = 10.0 + 0.1 * (299 + 60);
+    QVERIFY(qAbs(forecaster.forecast(60.0) - expected) < 0.05);
+}
+
+void TestHoltForecaster::clampsForecast()
+{
+    HoltForecaster rising;
+    HoltForecaster falling;
+    for (int t = 0; t < 300; ++t) {
+        rising.add(t, 50.0 + 0.1 * t);
+        falling.add(t, 50.0 - 0.1 * t);
+    }
+    QCOMPARE(rising.forecast(3600.0), 100.0);
+    QCOMPARE(falling.forecast(3600.0), 0.0);
+}
+
+QTEST_APPLESS_MAIN(TestHoltForecaster)
+#include "tst_holtforecaster.moc"
@@ -0,0 +1,101 @@
+#include "topologymap.h"
+#include <QtTest>
+#include <cmath>
+
+class TestTopologyMap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void groups();
+    void aggregate();
+    void unknownSocket();
+    void updateOnlyOnChange();
+
+private:
+    static CoreTopology core(int socket, int node, int physicalCore);
+};
+
+CoreTopology TestTopologyMap::core(int socket, int node, int physicalCore)
+{
+    CoreTopology topology;
+    topology.socket = socket;
+    topology.node = node;
+    topology.physicalCore = physicalCore;
+    return topology;
+}
+
+void TestTopologyMap::groups()
+{
+    // Ядра 0 и 3 — SMT-соседи; порядок групп не зависит от порядка ядер
+    TopologyMap map;
+    QVERIFY(map.update({core(0, 0, 0), core(1, 1, 0), core(0, 0, 1), core(0, 0, 0)}));
+
+    QCOMPARE(map.groupCount(TopologyMap::Level::Socket), 2);
+    QCOMPARE(map.groupCount(TopologyMap::Level::Node), 2);
+    QCOMPARE(map.groupCount(TopologyMap::Level::PhysicalCore), 3);
+
+    QCOMPARE(map.members(TopologyMap::Level::PhysicalCore, 0), QVector<int>({0, 3}));
+    QCOMPARE(map.members(TopologyMap::Level::PhysicalCore, 1), QVector<int>({2}));
+    QCOMPARE(map.members(TopologyMap::Level::PhysicalCore, 2), QVector<int>({1}));
+    QCOMPARE(map.groupOf(TopologyMap::Level::Node, 1), 1);
+    QCOMPARE(map.parentOf(TopologyMap::Level::PhysicalCore, 2), 1);
+    QCOMPARE(map.parentOf(TopologyMap::Level::Node, 1), 1);
+    QCOMPARE(map.parentOf(TopologyMap::Level::Socket, 1), -1);
+    QCOMPARE(map.groupName(TopologyMap::Level::Socket, 1), QString("Socket 1"));
+    QCOMPARE(map.groupName(TopologyMap::Level::PhysicalCore, 1), QString("Physical core 1"));
+}
+
+void TestTopologyMap::aggregate()
+{
+    TopologyMap map;
+    map.update({core(0, 0, 0), core(0, 0, 0), core(0, 0, 1), core(1, 1, 0)});
+
+    // Ядро 2 offline: его физическое ядро дает NaN, в узел оно не входит
+    const QVector<double> usages = {10.0, 30.0, std::nan(""), 50.0};
+    QVector<double> out;
+    QVector<int> counts;
+    map.aggregate(TopologyMap::Level::Node, usages, out, counts);
+    QCOMPARE(out, QVector<double>({20.0, 50.0}));
+    QCOMPARE(counts, QVector<int>({2, 1}));
+
+    map.aggregate(TopologyMap::Level::PhysicalCore, usages, out, counts);
+    QCOMPARE(out.size(), 3);
+    QCOMPARE(out[0], 20.0);
+    QVERIFY(std::isnan(out[1]));
+    QCOMPARE(out[2], 50.0);
+
+    // Ядра сэмпла за пределами карты в агрегаты не входят
+    map.aggregate(TopologyMap::Level::Socket, {10.0, 30.0, 20.0, 50.0, 100.0}, out, counts);
+    QCOMPARE(out, QVector<double>({20.0, 50.0}));
+}
+
+void TestTopologyMap::unknownSocket()
+{
+    TopologyMap map;
+    map.update({core(-1, -1, -1), core(0, 0, 0), core(-1, -1, -1)});
+
+    // Неизвестный сокет — последняя группа; ядра без номера физического ядра не объединяются
+    QCOMPARE(map.groupCount(TopologyMap::Level::Socket), 2);
+    QCOMPARE(map.groupName(TopologyMap::Level::Socket, 1), QString("Socket ?"));
+    QCOMPARE(map.members(TopologyMap::Level::Socket, 1), QVector<int>({0, 2}));
+    QCOMPARE(map.groupCount(TopologyMap::Level::PhysicalCore), 3);
+}
+
+void TestTopologyMap::updateOnlyOnChange()
+{
+    TopologyMap map;
+    const QVector<CoreTopology> topology = {core(0, 0, 0), core(0, 0, 1)};
+    QVERIFY(map.update(topology));
+    const quint32 revision = map.revision();
+
+    QVERIFY(!map.update(topology));
+    QCOMPARE(map.revision(), revision);
+
+    QVERIFY(map.update({core(0, 0, 0), core(0, 0, 0)}));
+    QVERIFY(map.revision() != revision);
+    QCOMPARE(map.groupCount(TopologyMap::Level::PhysicalCore), 1);
+}
+
+QTEST_APPLESS_MAIN(TestTopologyMap)
+#include "tst_topologymap.moc"
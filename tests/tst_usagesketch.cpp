@@ -0,0 +1,73 @@
+#include "usagesketch.h"
+#include <QtTest>
+#include <cmath>
+
+class TestUsageSketch : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void empty();
+    void quantilesOfUniformValues();
+    void mergeMatchesSingleSketch();
+    void clampsAndSkipsNan();
+};
+
+void TestUsageSketch::empty()
+{
+    UsageSketch sketch;
+    QVERIFY(sketch.isEmpty());
+    QVERIFY(std::isnan(sketch.quantile(0.5)));
+    QCOMPARE(sketch.mean(), 0.0);
+}
+
+void TestUsageSketch::quantilesOfUniformValues()
+{
+    // По значению в середине каждой корзины: ранг q * 99, внутри корзины
+    // значение интерполируется, поэтому квантили считаются вручную точно
+    UsageSketch sketch;
+    for (int i = 0; i < UsageSketch::BINS; ++i) {
+        sketch.add(i + 0.5);
+    }
+
+    QCOMPARE(sketch.count(), quint32(100));
+    QCOMPARE(sketch.min(), 0.5);
+    QCOMPARE(sketch.max(), 99.5);
+    QCOMPARE(sketch.mean(), 50.0);
+    QCOMPARE(sketch.quantile(0.0), 0.5);
+    QCOMPARE(sketch.quantile(0.5), 50.0);
+    QVERIFY(qAbs(sketch.quantile(0.95) - 94.55) < 1e-9);
+    QVERIFY(qAbs(sketch.quantile(0.99) - 98.51) < 1e-9);
+    QCOMPARE(sketch.quantile(1.0), 99.5);
+}
+
+void TestUsageSketch::mergeMatchesSingleSketch()
+{
+    UsageSketch low;
+    UsageSketch high;
+    for (int i = 0; i < 50; ++i) {
+        low.add(i + 0.5);
+        high.add(i + 50.5);
+    }
+    low.merge(high);
+
+    QCOMPARE(low.count(), quint32(100));
+    QCOMPARE(low.min(), 0.5);
+    QCOMPARE(low.max(), 99.5);
+    QVERIFY(qAbs(low.quantile(0.95) - 94.55) < 1e-9);
+}
+
+void TestUsageSketch::clampsAndSkipsNan()
+{
+    UsageSketch sketch;
+    sketch.add(150.0);
+    sketch.add(-5.0);
+    sketch.add(std::nan(""));
+
+    QCOMPARE(sketch.count(), quint32(2));
+    QCOMPARE(sketch.min(), 0.0);
+    QCOMPARE(sketch.max(), 100.0);
+}
+
+QTEST_APPLESS_MAIN(TestUsageSketch)
+#include "tst_usagesketch.moc"